@@ -59,7 +59,7 @@
 #define configSUPPORT_STATIC_ALLOCATION          1
 #define configSUPPORT_DYNAMIC_ALLOCATION         1
 #define configUSE_IDLE_HOOK                      0
-#define configUSE_TICK_HOOK                      0
+#define configUSE_TICK_HOOK                      1
 #define configCPU_CLOCK_HZ                       ( SystemCoreClock )
 #define configTICK_RATE_HZ                       ((TickType_t)1000)
 #define configMAX_PRIORITIES                     ( 7 )
@@ -134,6 +134,35 @@ standard names. */
 
 /* USER CODE BEGIN Defines */
 /* Section where parameter definitions can be added (for instance, to override default ones in FreeRTOS.h) */
+/* DMA heap in RAM_D2 (32K): UART RX/TX buffers and rings, debug packets */
+#define configTOTAL_DMA_HEAP_SIZE                8192 /* used in #if, no cast */
+
+/* Run-time statistics on the DWT cycle counter, see PYRo/Debug/RTOS_Stat.
+   Only built in with RTOS_STAT_DEBUG_EN, so the context switch stays
+   untouched otherwise. CYCCNT is started by dwt_drv_t::init(); until then
+   every task reads 0. */
+#include "pyro_core_config.h"
+#define INCLUDE_uxTaskGetStackHighWaterMark      1
+#if defined(RTOS_STAT_DEBUG_EN) && RTOS_STAT_DEBUG_EN
+#define configUSE_TRACE_FACILITY                 1
+#define configGENERATE_RUN_TIME_STATS            1
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
+#define portGET_RUN_TIME_COUNTER_VALUE()         (*(volatile uint32_t *)0xE0001004UL) /* DWT->CYCCNT */
+
+/* Per-task slice and burst accounting. The macros expand inside tasks.c,
+   where pxCurrentTCB and the ready lists are visible. */
+#if defined(__ICCARM__) || defined(__CC_ARM) || defined(__GNUC__)
+void pyro_rtos_stat_task_create(void *handle, uint32_t task_num);
+void pyro_rtos_stat_task_delete(uint32_t task_num);
+void pyro_rtos_stat_switched_in(uint32_t task_num);
+void pyro_rtos_stat_switched_out(uint32_t task_num, uint32_t ready);
+#endif
+#define traceTASK_CREATE(pxNewTCB)               pyro_rtos_stat_task_create((pxNewTCB), (pxNewTCB)->uxTCBNumber)
+#define traceTASK_DELETE(pxTCB)                  pyro_rtos_stat_task_delete((pxTCB)->uxTCBNumber)
+#define traceTASK_SWITCHED_IN()                  pyro_rtos_stat_switched_in(pxCurrentTCB->uxTCBNumber)
+#define traceTASK_SWITCHED_OUT()                 pyro_rtos_stat_switched_out(pxCurrentTCB->uxTCBNumber, \
+    listIS_CONTAINED_WITHIN(&(pxReadyTasksLists[pxCurrentTCB->uxPriority]), &(pxCurrentTCB->xStateListItem)))
+#endif
 /* USER CODE END Defines */
 
 #endif /* FREERTOS_CONFIG_H */
@@ -2,87 +2,200 @@
  * @file pyro_algo_ols.h
  * @brief Header file for the PYRO C++ Ordinary Least Squares (OLS) class.
  *
- * This file defines the `pyro::ols_t` class, which encapsulates
- * OLS linear regression functionality, primarily for signal differentiation.
+ * This file defines the `pyro::ols_buf_t` class template, which encapsulates
+ * OLS linear regression functionality, primarily for signal differentiation,
+ * and the `pyro::ols_t` alias used by the PID controller.
  *
  * @author Wang Hongxi (Original C)
  * @author Lucky (C++ Refactor)
- * @version 1.0.0
- * @date 2025-11-13
+ * @version 1.1.0
+ * @date 2026-10-17
  */
 
 #ifndef __PYRO_ALGO_OLS_H__
 #define __PYRO_ALGO_OLS_H__
 
+#include <array>
+#include <cmath>
 #include <cstdint>
-#include <vector>
 
 namespace pyro
 {
 
 /**
- * @brief Ordinary Least Squares (OLS) Linear Regression C++ Implementation.
+ * @brief Sliding-window Ordinary Least Squares (OLS) linear regression.
  *
- * This class refactors the C implementation into an object-oriented
- * C++ class. It uses std::vector for automatic memory management (RAII)
- * and provides a clean API for updating data and retrieving results.
+ * Samples live in a ring buffer of fixed capacity and the four regression
+ * sums (x^2, x, xy, y) are updated in O(1) per sample: the oldest point is
+ * subtracted, the new one added. Once per window the sums are recomputed
+ * from the ring with x rebased to the oldest sample, which bounds both the
+ * rounding error of the running sums and the growth of x.
+ *
+ * Results match the original shifting implementation, including its
+ * warm-up behaviour (sums over the samples seen so far, divided by order).
+ *
+ * @tparam Capacity Largest window size, the order is clamped to it.
  */
-class ols_t
+template <uint16_t Capacity> class ols_buf_t
 {
+    static_assert(Capacity >= 2, "linear regression needs two points");
+
   public:
     /**
      * @brief Constructs the OLS filter.
-     * @param order The number of samples (window size) for regression.
-     * Note: order must be greater than 1.
+     * @param order The number of samples (window size) for regression,
+     * clamped to [2, Capacity].
      */
-    explicit ols_t(uint16_t order);
+    explicit ols_buf_t(uint16_t order = Capacity)
+        : _order(order < 2 ? 2 : (order > Capacity ? Capacity : order))
+    {
+    }
 
     /**
      * @brief Updates the OLS filter with a new data point.
      *
-     * This function adds the new (deltax, y) point to the data window,
-     * pushing out the oldest point. It then recalculates the
-     * slope (k), intercept (b), and mean absolute deviation.
+     * Adds the new (deltax, y) point to the data window, pushing out the
+     * oldest point, and recalculates the slope (k) and intercept (b).
      *
      * @param deltax The time elapsed (or change in x) since the last point.
      * @param y The new y-value (signal value).
      */
-    void update(float deltax, float y);
+    void update(const float deltax, const float y)
+    {
+        const float x = _x_last + deltax;
+        if (_count == _order)
+        {
+            const float x_old = _x[_head];
+            const float y_old = _y[_head];
+            _sxx -= x_old * x_old;
+            _sx -= x_old;
+            _sxy -= x_old * y_old;
+            _sy -= y_old;
+        }
+        else
+        {
+            _count++;
+        }
+
+        _x[_head] = x;
+        _y[_head] = y;
+        _sxx += x * x;
+        _sx += x;
+        _sxy += x * y;
+        _sy += y;
+        _head   = (_head + 1) % _order;
+        _x_last = x;
+
+        if (_count == _order && ++_update_num >= _order)
+        {
+            recompute();
+        }
+        solve();
+    }
 
     /**
      * @brief Gets the calculated derivative (slope 'k').
      * @return The current derivative (k) of the linear regression.
      */
-    float get_derivative() const;
+    float get_derivative() const
+    {
+        return _k;
+    }
 
     /**
      * @brief Gets the smoothed signal value.
-     * @return The most recent smoothed y-value, calculated as (k * x_last + b).
+     * @return The most recent smoothed y-value, calculated as
+     * (k * x_last + b).
      */
-    float get_smooth() const;
+    float get_smooth() const
+    {
+        return _k * _x_last + _b;
+    }
 
     /**
-     * @brief Gets the Mean Absolute Deviation.
-     * @note The original C code named this 'StandardDeviation',
-     * but the calculation is Mean Absolute Deviation (MAD).
+     * @brief Gets the Mean Absolute Deviation, O(order) per call.
+     * @note Divided by order, not by the samples seen, like the original C.
      * @return The current mean absolute deviation of the regression line.
      */
-    float get_mean_absolute_deviation() const;
+    float get_mean_absolute_deviation() const
+    {
+        float deviation = 0.0f;
+        for (uint16_t i = 0; i < _count; ++i)
+        {
+            deviation += std::fabs(_k * _x[i] + _b - _y[i]);
+        }
+        return deviation / static_cast<float>(_order);
+    }
+
+    uint16_t get_order() const
+    {
+        return _order;
+    }
 
   private:
-    // Member variables
+    /**
+     * @brief Rebases x to the oldest sample and re-sums the full window.
+     */
+    void recompute()
+    {
+        const float origin = _x[_head]; // Oldest, the window is full
+        _sxx = _sx = _sxy = _sy = 0.0f;
+        for (uint16_t n = 0, i = _head; n < _order; ++n)
+        {
+            const float x = _x[i] - origin;
+            _x[i]         = x;
+            _sxx += x * x;
+            _sx += x;
+            _sxy += x * _y[i];
+            _sy += _y[i];
+            i = (i + 1 == _order) ? 0 : i + 1;
+        }
+        _x_last -= origin;
+        _update_num = 0;
+    }
+
+    void solve()
+    {
+        const auto n            = static_cast<float>(_order);
+        const float denominator = _sxx * n - _sx * _sx;
+        if (std::fabs(denominator) > 1e-9f)
+        {
+            _k = (_sxy * n - _sx * _sy) / denominator;
+            _b = (_sxx * _sy - _sx * _sxy) / denominator;
+        }
+        else
+        {
+            // All x values are the same, no slope: b is the mean of y
+            _k = 0.0f;
+            _b = _sy / static_cast<float>(_count);
+        }
+    }
+
     uint16_t _order;
-    uint32_t _count;
+    uint16_t _count{};      // Samples in the window, up to _order
+    uint16_t _head{};       // Next slot to write, the oldest when full
+    uint16_t _update_num{}; // Updates since the last recompute()
 
-    std::vector<float> _x;
-    std::vector<float> _y;
+    std::array<float, Capacity> _x{};
+    std::array<float, Capacity> _y{};
+    float _x_last{};
 
-    float _k; // Slope (k)
-    float _b; // Intercept (b)
+    float _sxx{}; // sum(x^2)
+    float _sx{};  // sum(x)
+    float _sxy{}; // sum(xy)
+    float _sy{};  // sum(y)
 
-    float _deviation; // Mean absolute deviation
+    float _k{}; // Slope (k)
+    float _b{}; // Intercept (b)
 };
 
+/**
+ * @brief Window capacity of the OLS embedded in every pid_t.
+ */
+static constexpr uint16_t OLS_MAX_ORDER = 16;
+
+using ols_t = ols_buf_t<OLS_MAX_ORDER>;
+
 } // namespace pyro
 
-#endif // __PYRO_ALGO_OLS_H__
\ No newline at end of file
+#endif // __PYRO_ALGO_OLS_H__
@@ -6,8 +6,8 @@
  * and the main PID calculation logic.
  *
  * @author Wang Hongxi (Original C), Lucky (C++ Refactor)
- * @version 1.1.4
- * @date 2025-11-16
+ * @version 1.2.0
+ * @date 2026-10-17
  * @copyright [Copyright Information Here]
  */
 
@@ -15,6 +15,7 @@
 #include "pyro_algo_pid.h"
 #include "pyro_core_def.h"
 #include "pyro_dwt_drv.h" // For pyro::dwt_drv_t
+#include "pyro_profile.h"
 #include <cmath>          // For std::fabs
 
 namespace pyro
@@ -93,18 +94,38 @@ pid_t::pid_t(const float max_out, const float integral_limit,
 /* Public Methods ------------------------------------------------------------*/
 
 /**
- * @brief Calculates the PID output.
+ * @brief Calculates the PID output, dt measured with the DWT counter.
  */
 float pid_t::calculate(const float ref, const float measure)
 {
+    _dt = dwt_drv_t::get_delta_t(&_dwt_cnt);
+    return update(ref, measure);
+}
+
+/**
+ * @brief Calculates the PID output over a given time step.
+ *
+ * Also restarts the DWT timebase, so a later calculate(ref, measure) does
+ * not see the whole span since the last DWT-timed call.
+ */
+float pid_t::calculate(const float ref, const float measure, const float dt)
+{
+    _dwt_cnt = dwt_drv_t::get_current_ticks();
+    _dt      = dt;
+    return update(ref, measure);
+}
+
+/**
+ * @brief One PID step over _dt.
+ */
+float pid_t::update(const float ref, const float measure)
+{
+    PYRO_PROFILE_SCOPE("pid_calculate");
     if (_improve & improvement_t::ERROR_HANDLE)
     {
         handle_error();
     }
 
-    // Get time delta from DWT
-    _dt = dwt_drv_t::get_delta_t(&_dwt_cnt);
-
     // Prevent division by zero if dt is too small or 0
     if (_dt < 1e-9f)
     {
@@ -7,8 +7,8 @@
  * It is a C++ refactor of the original C controller library.
  *
  * @author Wang Hongxi (Original C), Lucky (C++ Refactor)
- * @version 1.1.4
- * @date 2025-11-16
+ * @version 1.2.0
+ * @date 2026-10-17
  * @copyright [Copyright Information Here]
  */
 
@@ -25,8 +25,8 @@ namespace pyro
  * @brief PID Controller C++ Class.
  *
  * Encapsulates PID logic, state, and optional improvements.
- * Automatically uses `dwt_drv_t` for time delta and `ols_t` for
- * derivative calculation if specified.
+ * Uses `dwt_drv_t` for the time delta unless the caller passes one, and
+ * `ols_t` for derivative calculation if specified.
  */
 class pid_t
 {
@@ -130,13 +130,26 @@ class pid_t
           uint16_t ols_order, uint8_t improve);
 
     /**
-     * @brief Calculates the PID output.
+     * @brief Calculates the PID output, dt measured with the DWT counter.
      * @param ref The desired reference (setpoint) value.
      * @param measure The current measured value.
      * @return The calculated PID output.
      */
     float calculate(float ref, float measure);
 
+    /**
+     * @brief Calculates the PID output over a given time step.
+     *
+     * Output depends only on the inputs and dt, so a loop driven at a fixed
+     * period is reproducible on and off target.
+     *
+     * @param ref The desired reference (setpoint) value.
+     * @param measure The current measured value.
+     * @param dt Seconds since the previous call, e.g. the task period.
+     * @return The calculated PID output.
+     */
+    float calculate(float ref, float measure, float dt);
+
     /**
      * @brief Clears the internal PID state (I-term, D-term, error, etc.).
      */
@@ -182,6 +195,8 @@ class pid_t
     }
 
   private:
+    float update(float ref, float measure);
+
     // --- Private Helper Functions (PID Improvements) ---
     void trapezoid_integral();
     void limit_integral();
@@ -224,7 +239,7 @@ class pid_t
 
     // Dependencies
     uint32_t _dwt_cnt   = 0;    ///< Counter for DWT delta-time calculation
-    float _dt           = 0.0f; ///< Delta-time from DWT
+    float _dt           = 0.0f; ///< Delta-time of the last calculation
     ols_t _ols;                 ///< OLS instance (constructed with _ols_order)
 };
 
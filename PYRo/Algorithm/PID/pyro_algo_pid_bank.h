@@ -0,0 +1,294 @@
+/**
+ * @file pyro_algo_pid_bank.h
+ * @brief Structure-of-arrays bank of PID controllers sharing one time step.
+ *
+ * This file defines `pyro::pid_bank_t`, N PID lanes for motor groups that
+ * are updated together (chassis wheels, friction wheels and trigger). Gains
+ * and state are stored per field across lanes, dt is read once per tick and
+ * all lanes are stepped in one loop. The improvement set is shared by the
+ * bank and tested once per tick, not once per lane.
+ *
+ * Each lane reproduces `pid_t::calculate` with the same improvement flags,
+ * operation for operation. The OLS derivative, user callbacks and the error
+ * handler are per-controller features and stay with `pid_t`.
+ *
+ * @version 1.0.0
+ * @date 2026-10-17
+ */
+
+#ifndef __PYRO_ALGO_PID_BANK_H__
+#define __PYRO_ALGO_PID_BANK_H__
+
+#include "pyro_algo_pid.h"        // For pid_t::improvement_t
+#include "pyro_algo_pid_policy.h" // For pid_param_t
+#include "pyro_core_def.h"
+#include "pyro_dwt_drv.h"
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+namespace pyro
+{
+
+/**
+ * @brief N PID controllers in structure-of-arrays layout.
+ *
+ * @tparam N Number of lanes.
+ */
+template <uint8_t N> class pid_bank_t
+{
+    static_assert(N > 0, "empty bank");
+
+  public:
+    using lanes_t = std::array<float, N>;
+
+    /**
+     * @param improve pid_t::improvement_t flags applied to every lane.
+     * ERROR_HANDLE and PROPORTIONAL_ON_MEASUREMENT are ignored.
+     */
+    explicit pid_bank_t(const uint8_t improve = pid_t::INTEGRAL_LIMIT)
+        : _improve(improve)
+    {
+        clear();
+    }
+
+    /**
+     * @brief Configures one lane, as the pid_t constructors would.
+     */
+    void set_lane(const uint8_t lane, const pid_param_t &param)
+    {
+        if (lane >= N)
+        {
+            return;
+        }
+        _kp[lane]             = param.kp;
+        _ki[lane]             = param.ki;
+        _kd[lane]             = param.kd;
+        _max_out[lane]        = param.max_out;
+        _integral_limit[lane] = param.integral_limit;
+        _deadband[lane]       = param.deadband;
+        _coef_a[lane]         = param.coef_a;
+        _coef_b[lane]         = param.coef_b;
+        _output_lpf_rc[lane] =
+            (param.output_cutoff_hz > 0.0f)
+                ? (1.0f / (2.0f * PI * param.output_cutoff_hz))
+                : 0.0f;
+        _derivative_lpf_rc[lane] =
+            (param.derivative_cutoff_hz > 0.0f)
+                ? (1.0f / (2.0f * PI * param.derivative_cutoff_hz))
+                : 0.0f;
+    }
+
+    void set_gains(const uint8_t lane, const float kp, const float ki,
+                   const float kd)
+    {
+        if (lane < N)
+        {
+            _kp[lane] = kp;
+            _ki[lane] = ki;
+            _kd[lane] = kd;
+        }
+    }
+
+    /**
+     * @brief Steps every lane, dt taken once from the DWT counter.
+     * @return The outputs of all lanes.
+     */
+    const lanes_t &calculate(const lanes_t &ref, const lanes_t &measure)
+    {
+        return update(ref, measure, dwt_drv_t::get_delta_t(&_dwt_cnt));
+    }
+
+    /**
+     * @brief Steps every lane over a given time step.
+     *
+     * Also restarts the DWT timebase, like pid_t.
+     *
+     * @param dt Seconds since the previous call, shared by all lanes.
+     * @return The outputs of all lanes.
+     */
+    const lanes_t &calculate(const lanes_t &ref, const lanes_t &measure,
+                             const float dt)
+    {
+        _dwt_cnt = dwt_drv_t::get_current_ticks();
+        return update(ref, measure, dt);
+    }
+
+    /**
+     * @brief Clears the state of every lane.
+     */
+    void clear()
+    {
+        _err.fill(0.0f);
+        _last_err.fill(0.0f);
+        _last_measure.fill(0.0f);
+        _p_out.fill(0.0f);
+        _i_out.fill(0.0f);
+        _d_out.fill(0.0f);
+        _last_d_out.fill(0.0f);
+        _output.fill(0.0f);
+        _last_output.fill(0.0f);
+        _dwt_cnt = 0;
+    }
+
+    // --- Getters ---
+    [[nodiscard]] const lanes_t &get_output() const
+    {
+        return _output;
+    }
+    [[nodiscard]] float get_output(const uint8_t lane) const
+    {
+        return lane < N ? _output[lane] : 0.0f;
+    }
+    [[nodiscard]] float get_p_out(const uint8_t lane) const
+    {
+        return lane < N ? _p_out[lane] : 0.0f;
+    }
+    [[nodiscard]] float get_i_out(const uint8_t lane) const
+    {
+        return lane < N ? _i_out[lane] : 0.0f;
+    }
+    [[nodiscard]] float get_d_out(const uint8_t lane) const
+    {
+        return lane < N ? _d_out[lane] : 0.0f;
+    }
+    [[nodiscard]] float get_error(const uint8_t lane) const
+    {
+        return lane < N ? _err[lane] : 0.0f;
+    }
+
+  private:
+    /**
+     * @brief One step of every lane over dt.
+     */
+    const lanes_t &update(const lanes_t &ref, const lanes_t &measure,
+                          const float dt)
+    {
+        if (dt < 1e-9f)
+        {
+            _last_measure = measure;
+            return _output; // Keep last output
+        }
+
+        const bool trapezoid  = _improve & pid_t::TRAPEZOID_INTEGRAL;
+        const bool d_on_m     = _improve & pid_t::DERIVATIVE_ON_MEASUREMENT;
+        const bool rate       = _improve & pid_t::CHANGING_INTEGRATION_RATE;
+        const bool d_filter   = _improve & pid_t::DERIVATIVE_FILTER;
+        const bool i_limit    = _improve & pid_t::INTEGRAL_LIMIT;
+        const bool out_filter = _improve & pid_t::OUTPUT_FILTER;
+
+        for (uint8_t i = 0; i < N; i++)
+        {
+            const float err = ref[i] - measure[i];
+            _err[i]         = err;
+            if (std::fabs(err) > _deadband[i])
+            {
+                const float last_err = _last_err[i];
+                const float p_out    = _kp[i] * err;
+                float i_term =
+                    trapezoid ? _ki[i] * ((err + last_err) / 2.0f) * dt
+                              : _ki[i] * err * dt;
+                float d_out =
+                    d_on_m ? _kd[i] * (_last_measure[i] - measure[i]) / dt
+                           : _kd[i] * (err - last_err) / dt;
+                float i_out         = _i_out[i];
+                const float max_out = _max_out[i];
+
+                if (rate && err * i_out > 0)
+                {
+                    const float err_abs = std::fabs(err);
+                    const float coef_a  = _coef_a[i];
+                    const float coef_b  = _coef_b[i];
+                    if (err_abs > coef_b)
+                    {
+                        i_term = (err_abs <= (coef_a + coef_b))
+                                     ? i_term * ((coef_a - err_abs + coef_b) /
+                                                 coef_a)
+                                     : 0.0f;
+                    }
+                }
+                const float d_rc = _derivative_lpf_rc[i];
+                if (d_filter && d_rc > 0.0f)
+                {
+                    d_out = d_out * dt / (d_rc + dt) +
+                            _last_d_out[i] * d_rc / (d_rc + dt);
+                }
+                if (i_limit)
+                {
+                    const float limit  = _integral_limit[i];
+                    const float i_next = i_out + i_term;
+                    // Anti-Windup: Stop integrating if output is saturated
+                    if (std::fabs(p_out + i_next + d_out) > max_out &&
+                        err * i_out > 0)
+                    {
+                        i_term = 0.0f;
+                    }
+                    // Clamp I-Term: Hard limit on the integral value
+                    if (i_next > limit)
+                    {
+                        i_term = 0.0f;
+                        i_out  = limit;
+                    }
+                    else if (i_next < -limit)
+                    {
+                        i_term = 0.0f;
+                        i_out  = -limit;
+                    }
+                }
+                i_out += i_term;
+
+                float output     = p_out + i_out + d_out;
+                const float o_rc = _output_lpf_rc[i];
+                if (out_filter && o_rc > 0.0f)
+                {
+                    output = output * dt / (o_rc + dt) +
+                             _last_output[i] * o_rc / (o_rc + dt);
+                }
+                _p_out[i]  = clamp(p_out, max_out);
+                _i_out[i]  = i_out;
+                _d_out[i]  = d_out;
+                _output[i] = clamp(output, max_out);
+            }
+
+            _last_measure[i] = measure[i];
+            _last_output[i]  = _output[i];
+            _last_d_out[i]   = _d_out[i];
+            _last_err[i]     = err;
+        }
+        return _output;
+    }
+
+    static float clamp(const float value, const float max_out)
+    {
+        if (value > max_out)
+        {
+            return max_out;
+        }
+        if (value < -max_out)
+        {
+            return -max_out;
+        }
+        return value;
+    }
+
+    uint8_t _improve;
+    uint32_t _dwt_cnt{};
+
+    // Configuration
+    lanes_t _kp{}, _ki{}, _kd{};
+    lanes_t _max_out{}, _integral_limit{};
+    lanes_t _deadband{};
+    lanes_t _coef_a{}, _coef_b{};
+    lanes_t _output_lpf_rc{}, _derivative_lpf_rc{};
+
+    // State
+    lanes_t _err{}, _last_err{};
+    lanes_t _last_measure{};
+    lanes_t _p_out{}, _i_out{}, _d_out{}, _last_d_out{};
+    lanes_t _output{}, _last_output{};
+};
+
+} // namespace pyro
+
+#endif // __PYRO_ALGO_PID_BANK_H__
@@ -0,0 +1,489 @@
+/**
+ * @file pyro_algo_pid_policy.h
+ * @brief Compile-time configured PID controller.
+ *
+ * This file defines `pyro::policy_pid_t`, a header-only counterpart of
+ * `pyro::pid_t` whose improvements are selected by policy tags instead of
+ * the runtime `improve` bitmask. Features that are not listed compile out:
+ * no branch in calculate() and no member in the object.
+ *
+ * The arithmetic follows `pid_t::calculate` step for step, so with the same
+ * gains, inputs and dt it produces the output of `pid_t` built with the
+ * equivalent bitmask and ols_order. User callbacks and the motor-blocked
+ * error handler stay with `pid_t`.
+ *
+ * @version 1.0.0
+ * @date 2026-10-17
+ */
+
+#ifndef __PYRO_ALGO_PID_POLICY_H__
+#define __PYRO_ALGO_PID_POLICY_H__
+
+#include "pyro_algo_ols.h"
+#include "pyro_core_def.h" // For PI
+#include "pyro_dwt_drv.h"
+
+#include <cmath>
+#include <cstdint>
+#include <type_traits>
+
+namespace pyro
+{
+
+/**
+ * @brief Policy tags for policy_pid_t, one per pid_t::improvement_t flag.
+ */
+namespace pid_policy
+{
+struct integral_limit {};            ///< INTEGRAL_LIMIT
+struct derivative_on_measurement {}; ///< DERIVATIVE_ON_MEASUREMENT
+struct trapezoid_integral {};        ///< TRAPEZOID_INTEGRAL
+struct output_filter {};             ///< OUTPUT_FILTER
+struct changing_integration_rate {}; ///< CHANGING_INTEGRATION_RATE
+struct derivative_filter {};         ///< DERIVATIVE_FILTER
+struct deadband {};                  ///< pid_t deadband > 0
+
+/**
+ * @brief D term from an OLS fit over the last Order samples, pid_t with
+ * ols_order = Order.
+ */
+template <uint16_t Order> struct ols_derivative
+{
+    static_assert(Order > 2, "pid_t falls back to the difference below 3");
+    static_assert(Order <= OLS_MAX_ORDER, "pid_t clamps the order to this");
+};
+} // namespace pid_policy
+
+namespace pid_detail
+{
+template <typename P, typename... Ps>
+inline constexpr bool has_v = (std::is_same_v<P, Ps> || ...);
+
+template <typename P> struct ols_order
+{
+    static constexpr uint16_t value = 0;
+};
+template <uint16_t N> struct ols_order<pid_policy::ols_derivative<N>>
+{
+    static constexpr uint16_t value = N;
+};
+
+template <typename P>
+inline constexpr bool known_v =
+    ols_order<P>::value > 0 ||
+    has_v<P, pid_policy::integral_limit, pid_policy::derivative_on_measurement,
+          pid_policy::trapezoid_integral, pid_policy::output_filter,
+          pid_policy::changing_integration_rate,
+          pid_policy::derivative_filter, pid_policy::deadband>;
+
+// Optional state, each an empty base when its feature is compiled out
+template <typename State> struct off_t
+{
+};
+template <bool Enable, typename State>
+using opt_t = std::conditional_t<Enable, State, off_t<State>>;
+
+struct integral_limit_t
+{
+    float _integral_limit;
+};
+struct deadband_t
+{
+    float _deadband;
+};
+struct integration_rate_t
+{
+    float _coef_a, _coef_b;
+};
+struct derivative_filter_t
+{
+    float _derivative_lpf_rc;
+    float _last_d_out;
+};
+struct output_filter_t
+{
+    float _output_lpf_rc;
+    float _last_output;
+};
+struct last_err_t
+{
+    float _last_err;
+};
+struct last_measure_t
+{
+    float _last_measure;
+};
+template <uint16_t N> struct ols_state_t
+{
+    ols_buf_t<N> _ols{N};
+};
+} // namespace pid_detail
+
+/**
+ * @brief Parameters of policy_pid_t. Fields of features that are compiled
+ * out are ignored.
+ */
+struct pid_param_t
+{
+    float kp;
+    float ki;
+    float kd;
+    float max_out;
+    float integral_limit       = 0.0f;
+    float deadband             = 0.0f;
+    float coef_a               = 0.0f; ///< ChangingIntegrationRate
+    float coef_b               = 0.0f; ///< ChangingIntegrationRate
+    float output_cutoff_hz     = 0.0f; ///< 0 leaves the filter transparent
+    float derivative_cutoff_hz = 0.0f; ///< 0 leaves the filter transparent
+};
+
+/**
+ * @brief PID controller with its improvements chosen at compile time.
+ *
+ * @tparam Policies Any set of pyro::pid_policy tags, order is irrelevant.
+ */
+template <typename... Policies>
+class policy_pid_t
+    : private pid_detail::opt_t<
+          pid_detail::has_v<pid_policy::integral_limit, Policies...>,
+          pid_detail::integral_limit_t>,
+      private pid_detail::opt_t<
+          pid_detail::has_v<pid_policy::deadband, Policies...>,
+          pid_detail::deadband_t>,
+      private pid_detail::opt_t<
+          pid_detail::has_v<pid_policy::changing_integration_rate,
+                            Policies...>,
+          pid_detail::integration_rate_t>,
+      private pid_detail::opt_t<
+          pid_detail::has_v<pid_policy::derivative_filter, Policies...>,
+          pid_detail::derivative_filter_t>,
+      private pid_detail::opt_t<
+          pid_detail::has_v<pid_policy::output_filter, Policies...>,
+          pid_detail::output_filter_t>,
+      private pid_detail::opt_t<
+          pid_detail::has_v<pid_policy::trapezoid_integral, Policies...> ||
+              (0 == (pid_detail::ols_order<Policies>::value + ... + 0) &&
+               !pid_detail::has_v<pid_policy::derivative_on_measurement,
+                                  Policies...>),
+          pid_detail::last_err_t>,
+      private pid_detail::opt_t<
+          0 == (pid_detail::ols_order<Policies>::value + ... + 0) &&
+              pid_detail::has_v<pid_policy::derivative_on_measurement,
+                                Policies...>,
+          pid_detail::last_measure_t>,
+      private pid_detail::opt_t<
+          0 != (pid_detail::ols_order<Policies>::value + ... + 0),
+          pid_detail::ols_state_t<(pid_detail::ols_order<Policies>::value +
+                                   ... + 0)>>
+{
+    static_assert((pid_detail::known_v<Policies> && ...),
+                  "unknown pid_policy tag");
+
+    template <typename P>
+    static constexpr bool HAS = pid_detail::has_v<P, Policies...>;
+
+    static constexpr uint16_t OLS_ORDER =
+        (pid_detail::ols_order<Policies>::value + ... + 0);
+    static_assert((((pid_detail::ols_order<Policies>::value > 0) ? 1 : 0) +
+                   ... + 0) <= 1,
+                  "at most one ols_derivative");
+
+    static constexpr bool INTEGRAL_LIMIT = HAS<pid_policy::integral_limit>;
+    static constexpr bool DEADBAND       = HAS<pid_policy::deadband>;
+    static constexpr bool RATE = HAS<pid_policy::changing_integration_rate>;
+    static constexpr bool D_FILTER   = HAS<pid_policy::derivative_filter>;
+    static constexpr bool OUT_FILTER = HAS<pid_policy::output_filter>;
+    static constexpr bool TRAPEZOID  = HAS<pid_policy::trapezoid_integral>;
+    static constexpr bool D_ON_M = HAS<pid_policy::derivative_on_measurement>;
+    static constexpr bool OLS    = OLS_ORDER > 0;
+    static constexpr bool LAST_ERR     = TRAPEZOID || (!OLS && !D_ON_M);
+    static constexpr bool LAST_MEASURE = !OLS && D_ON_M;
+
+  public:
+    explicit policy_pid_t(const pid_param_t &param)
+        : _kp(param.kp), _ki(param.ki), _kd(param.kd), _max_out(param.max_out)
+    {
+        if constexpr (INTEGRAL_LIMIT)
+        {
+            this->_integral_limit = param.integral_limit;
+        }
+        if constexpr (DEADBAND)
+        {
+            this->_deadband = param.deadband;
+        }
+        if constexpr (RATE)
+        {
+            this->_coef_a = param.coef_a;
+            this->_coef_b = param.coef_b;
+        }
+        if constexpr (D_FILTER)
+        {
+            this->_derivative_lpf_rc =
+                (param.derivative_cutoff_hz > 0.0f)
+                    ? (1.0f / (2.0f * PI * param.derivative_cutoff_hz))
+                    : 0.0f;
+        }
+        if constexpr (OUT_FILTER)
+        {
+            this->_output_lpf_rc =
+                (param.output_cutoff_hz > 0.0f)
+                    ? (1.0f / (2.0f * PI * param.output_cutoff_hz))
+                    : 0.0f;
+        }
+        clear();
+    }
+
+    /**
+     * @brief Calculates the PID output, dt taken from the DWT counter.
+     */
+    float calculate(const float ref, const float measure)
+    {
+        return update(ref, measure, dwt_drv_t::get_delta_t(&_dwt_cnt));
+    }
+
+    /**
+     * @brief Calculates the PID output over a given time step.
+     *
+     * Also restarts the DWT timebase, like pid_t, so a later DWT-timed call
+     * does not see the whole span since the previous one.
+     *
+     * @param dt Seconds since the previous call.
+     */
+    float calculate(const float ref, const float measure, const float dt)
+    {
+        _dwt_cnt = dwt_drv_t::get_current_ticks();
+        return update(ref, measure, dt);
+    }
+
+    /**
+     * @brief Clears the internal state, the OLS history is kept like pid_t.
+     */
+    void clear()
+    {
+        _err     = 0.0f;
+        _p_out   = 0.0f;
+        _i_out   = 0.0f;
+        _d_out   = 0.0f;
+        _output  = 0.0f;
+        _dwt_cnt = 0;
+        if constexpr (LAST_MEASURE)
+        {
+            this->_last_measure = 0.0f;
+        }
+        if constexpr (OUT_FILTER)
+        {
+            this->_last_output = 0.0f;
+        }
+        if constexpr (D_FILTER)
+        {
+            this->_last_d_out = 0.0f;
+        }
+        if constexpr (LAST_ERR)
+        {
+            this->_last_err = 0.0f;
+        }
+    }
+
+    void set_gains(const float kp, const float ki, const float kd)
+    {
+        _kp = kp;
+        _ki = ki;
+        _kd = kd;
+    }
+
+    // --- Getters ---
+    [[nodiscard]] float get_output() const
+    {
+        return _output;
+    }
+    [[nodiscard]] float get_p_out() const
+    {
+        return _p_out;
+    }
+    [[nodiscard]] float get_i_out() const
+    {
+        return _i_out;
+    }
+    [[nodiscard]] float get_d_out() const
+    {
+        return _d_out;
+    }
+    [[nodiscard]] float get_error() const
+    {
+        return _err;
+    }
+
+  private:
+    /**
+     * @brief One PID step over dt.
+     */
+    float update(const float ref, const float measure, const float dt)
+    {
+        if (dt < 1e-9f)
+        {
+            if constexpr (LAST_MEASURE)
+            {
+                this->_last_measure = measure;
+            }
+            return _output; // Keep last output
+        }
+
+        _err = ref - measure;
+        if (std::fabs(_err) > deadband())
+        {
+            _p_out       = _kp * _err;
+            float i_term = 0.0f;
+            if constexpr (TRAPEZOID)
+            {
+                i_term = _ki * ((_err + this->_last_err) / 2.0f) * dt;
+            }
+            else
+            {
+                i_term = _ki * _err * dt;
+            }
+
+            if constexpr (OLS)
+            {
+                this->_ols.update(dt, D_ON_M ? -measure : _err);
+                _d_out = _kd * this->_ols.get_derivative();
+            }
+            else if constexpr (D_ON_M)
+            {
+                _d_out = _kd * (this->_last_measure - measure) / dt;
+            }
+            else
+            {
+                _d_out = _kd * (_err - this->_last_err) / dt;
+            }
+
+            if constexpr (RATE)
+            {
+                const float err_abs = std::fabs(_err);
+                const float coef_a  = this->_coef_a;
+                const float coef_b  = this->_coef_b;
+                if (_err * _i_out > 0 && err_abs > coef_b)
+                {
+                    i_term = (err_abs <= (coef_a + coef_b))
+                                 ? i_term * ((coef_a - err_abs + coef_b) /
+                                             coef_a)
+                                 : 0.0f;
+                }
+            }
+            if constexpr (D_FILTER)
+            {
+                const float rc = this->_derivative_lpf_rc;
+                if (rc > 0.0f)
+                {
+                    _d_out = _d_out * dt / (rc + dt) +
+                             this->_last_d_out * rc / (rc + dt);
+                }
+            }
+            if constexpr (INTEGRAL_LIMIT)
+            {
+                const float limit = this->_integral_limit;
+                const float i_out = _i_out + i_term;
+                // Anti-Windup: Stop integrating if output is saturated
+                if (std::fabs(_p_out + i_out + _d_out) > _max_out &&
+                    _err * _i_out > 0)
+                {
+                    i_term = 0.0f;
+                }
+                // Clamp I-Term: Hard limit on the integral value
+                if (i_out > limit)
+                {
+                    i_term = 0.0f;
+                    _i_out = limit;
+                }
+                else if (i_out < -limit)
+                {
+                    i_term = 0.0f;
+                    _i_out = -limit;
+                }
+            }
+            _i_out += i_term;
+
+            _output = _p_out + _i_out + _d_out;
+            if constexpr (OUT_FILTER)
+            {
+                const float rc = this->_output_lpf_rc;
+                if (rc > 0.0f)
+                {
+                    _output = _output * dt / (rc + dt) +
+                              this->_last_output * rc / (rc + dt);
+                }
+            }
+            _output = clamp(_output);
+            _p_out  = clamp(_p_out);
+        }
+
+        if constexpr (LAST_MEASURE)
+        {
+            this->_last_measure = measure;
+        }
+        if constexpr (OUT_FILTER)
+        {
+            this->_last_output = _output;
+        }
+        if constexpr (D_FILTER)
+        {
+            this->_last_d_out = _d_out;
+        }
+        if constexpr (LAST_ERR)
+        {
+            this->_last_err = _err;
+        }
+        return _output;
+    }
+
+    float deadband() const
+    {
+        if constexpr (DEADBAND)
+        {
+            return this->_deadband;
+        }
+        else
+        {
+            return 0.0f; // pid_t skips exact zero errors as well
+        }
+    }
+
+    float clamp(const float value) const
+    {
+        if (value > _max_out)
+        {
+            return _max_out;
+        }
+        if (value < -_max_out)
+        {
+            return -_max_out;
+        }
+        return value;
+    }
+
+    float _kp, _ki, _kd;
+    float _max_out;
+
+    float _err{};
+    float _p_out{};
+    float _i_out{};
+    float _d_out{};
+    float _output{};
+    uint32_t _dwt_cnt{}; ///< Timebase of the DWT-timed calculate()
+};
+
+/**
+ * @brief Wheel and friction speed loops, pid_t constructor 1 defaults.
+ */
+using chassis_pid_t = policy_pid_t<pid_policy::integral_limit>;
+
+/**
+ * @brief Gimbal loops, pid_t constructor 2 defaults with D on measurement.
+ */
+using gimbal_pid_t =
+    policy_pid_t<pid_policy::integral_limit,
+                 pid_policy::derivative_on_measurement,
+                 pid_policy::derivative_filter, pid_policy::output_filter>;
+
+} // namespace pyro
+
+#endif // __PYRO_ALGO_PID_POLICY_H__
@@ -0,0 +1,215 @@
+/**
+ * @file pyro_algo_pid_q31.cpp
+ * @brief Implementation file for the PYRO fixed-point (Q31) PID Controller.
+ *
+ * @version 1.0.0
+ * @date 2026-10-17
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "pyro_algo_pid_q31.h"
+
+#include <cmath>
+
+#if defined(__ARM_FEATURE_DSP)
+#include <arm_acle.h> // For __qadd / __qsub
+#endif
+
+namespace pyro
+{
+namespace
+{
+constexpr int64_t Q31_ONE = 1LL << 31;
+
+pid_q31_t::q31_t saturate(const int64_t value)
+{
+    if (value > INT32_MAX)
+    {
+        return INT32_MAX;
+    }
+    if (value < INT32_MIN)
+    {
+        return INT32_MIN;
+    }
+    return static_cast<pid_q31_t::q31_t>(value);
+}
+
+pid_q31_t::q31_t add(const pid_q31_t::q31_t a, const pid_q31_t::q31_t b)
+{
+#if defined(__ARM_FEATURE_DSP)
+    return __qadd(a, b);
+#else
+    return saturate(static_cast<int64_t>(a) + b);
+#endif
+}
+
+pid_q31_t::q31_t sub(const pid_q31_t::q31_t a, const pid_q31_t::q31_t b)
+{
+#if defined(__ARM_FEATURE_DSP)
+    return __qsub(a, b);
+#else
+    return saturate(static_cast<int64_t>(a) - b);
+#endif
+}
+
+pid_q31_t::q31_t clamp(const pid_q31_t::q31_t value,
+                       const pid_q31_t::q31_t limit)
+{
+    if (value > limit)
+    {
+        return limit;
+    }
+    if (value < -limit)
+    {
+        return -limit;
+    }
+    return value;
+}
+} // namespace
+
+/* Constructor Implementation ------------------------------------------------*/
+
+/**
+ * @brief Normalizes every constant to the Q31 scales. The gains map input
+ * fractions to output fractions, hence the in_range / out_full factor.
+ */
+pid_q31_t::pid_q31_t(const float kp, const float ki, const float kd,
+                     const float integral_limit, const float max_out,
+                     const float deadband, const float dt,
+                     const float in_range, const float out_range)
+    : _kp(make_gain(kp * in_range / (out_range * OUT_HEADROOM))),
+      _ki(make_gain(ki * dt * in_range / (out_range * OUT_HEADROOM))),
+      _kd(make_gain(kd / dt * in_range / (out_range * OUT_HEADROOM))),
+      _integral_limit(to_q31(integral_limit / (out_range * OUT_HEADROOM))),
+      _max_out(to_q31(max_out / (out_range * OUT_HEADROOM))),
+      _deadband(to_q31(deadband / in_range)),
+      _in_gain(std::llround(static_cast<double>(Q31_ONE) / in_range)),
+      _out_range(std::llround(out_range * OUT_HEADROOM)),
+      _out_scale(out_range * OUT_HEADROOM / static_cast<float>(Q31_ONE))
+{
+}
+
+/* Public Methods ------------------------------------------------------------*/
+
+/**
+ * @brief Calculates the PID output. Mirrors pid_t::calculate with
+ * INTEGRAL_LIMIT, in saturating integer arithmetic.
+ */
+pid_q31_t::q31_t pid_q31_t::calculate(const q31_t ref, const q31_t measure)
+{
+    _err = sub(ref, measure);
+
+    // Only calculate PID if error is outside the deadband
+    if (_err > _deadband || _err < -_deadband)
+    {
+        const q31_t p_out = mul(_kp, _err);
+        const q31_t d_out = mul(_kd, sub(_err, _last_err));
+        q31_t i_term      = mul(_ki, _err);
+
+        // Anti-Windup: Stop integrating if output is saturated
+        const q31_t i_next      = add(_i_out, i_term);
+        const q31_t temp_output = add(add(p_out, i_next), d_out);
+        const bool accumulating =
+            (_err > 0 && _i_out > 0) || (_err < 0 && _i_out < 0);
+        if ((temp_output > _max_out || temp_output < -_max_out) &&
+            accumulating)
+        {
+            i_term = 0;
+        }
+
+        // Clamp I-Term: Hard limit on the integral value
+        if (i_next > _integral_limit)
+        {
+            i_term = 0;
+            _i_out = _integral_limit;
+        }
+        else if (i_next < -_integral_limit)
+        {
+            i_term = 0;
+            _i_out = -_integral_limit;
+        }
+        _i_out = add(_i_out, i_term);
+
+        _output = clamp(add(add(p_out, _i_out), d_out), _max_out);
+    }
+
+    _last_err = _err;
+    return _output;
+}
+
+int16_t pid_q31_t::calculate_raw(const int32_t ref, const int32_t measure)
+{
+    const int32_t out =
+        q31_to_raw(calculate(raw_to_q31(ref), raw_to_q31(measure)));
+    if (out > INT16_MAX)
+    {
+        return INT16_MAX;
+    }
+    if (out < INT16_MIN)
+    {
+        return INT16_MIN;
+    }
+    return static_cast<int16_t>(out);
+}
+
+void pid_q31_t::clear()
+{
+    _err      = 0;
+    _last_err = 0;
+    _i_out    = 0;
+    _output   = 0;
+}
+
+pid_q31_t::q31_t pid_q31_t::raw_to_q31(const int32_t raw) const
+{
+    return saturate(static_cast<int64_t>(raw) * _in_gain);
+}
+
+int32_t pid_q31_t::q31_to_raw(const q31_t value) const
+{
+    return static_cast<int32_t>(
+        (static_cast<int64_t>(value) * _out_range + (1LL << 30)) >> 31);
+}
+
+float pid_q31_t::get_output() const
+{
+    return static_cast<float>(_output) * _out_scale;
+}
+
+float pid_q31_t::get_i_out() const
+{
+    return static_cast<float>(_i_out) * _out_scale;
+}
+
+/* Private Helper Functions --------------------------------------------------*/
+
+/**
+ * @brief Picks the smallest shift that brings |gain| below 1, so small
+ * gains keep all 31 bits of mantissa.
+ */
+pid_q31_t::gain_t pid_q31_t::make_gain(const float gain)
+{
+    uint8_t shift = 0;
+    while (shift < 30 && std::fabs(gain) >= static_cast<float>(1UL << shift))
+    {
+        shift++;
+    }
+    return {to_q31(std::ldexp(gain, -shift)), shift};
+}
+
+pid_q31_t::q31_t pid_q31_t::to_q31(const float value)
+{
+    return saturate(std::llround(static_cast<double>(value) * Q31_ONE));
+}
+
+/**
+ * @brief gain * x, rounded to nearest and saturated.
+ */
+pid_q31_t::q31_t pid_q31_t::mul(const gain_t &gain, const q31_t x)
+{
+    const int down = 31 - gain.shift;
+    return saturate((static_cast<int64_t>(gain.k) * x + (1LL << (down - 1))) >>
+                    down);
+}
+
+} // namespace pyro
@@ -0,0 +1,128 @@
+/**
+ * @file pyro_algo_pid_q31.h
+ * @brief Header file for the PYRO fixed-point (Q31) PID Controller class.
+ *
+ * This file defines `pyro::pid_q31_t`, a PID controller for loops that run
+ * in interrupt context (e.g. a current loop in the CAN RX callback). The
+ * calculation uses only saturating 32-bit integer arithmetic, so the ISR
+ * never touches the FPU and no floating-point context is stacked.
+ *
+ * Signals are Q31 fractions of a full scale: the input scale (e.g. 8192
+ * encoder counts) and the output scale (e.g. 16384 current units, with
+ * headroom for the terms before the clamp) are given at construction,
+ * together with the fixed loop period. Gains, limits and the raw-unit
+ * conversions are folded into integer constants there.
+ *
+ * @version 1.0.0
+ * @date 2026-10-17
+ */
+
+#ifndef __PYRO_ALGO_PID_Q31_H__
+#define __PYRO_ALGO_PID_Q31_H__
+
+#include <cstdint>
+
+namespace pyro
+{
+
+/**
+ * @brief Saturating Q31 PID with integral limit, output clamp and deadband.
+ *
+ * Same structure as `pid_t` with INTEGRAL_LIMIT: P, rectangular I, D on
+ * error, anti-windup and integral clamp as in pid_t::limit_integral, then
+ * the output clamp. Every sum saturates instead of wrapping.
+ */
+class pid_q31_t
+{
+  public:
+    using q31_t = int32_t;
+
+    /**
+     * @brief Output-side Q31 1.0 is OUT_HEADROOM * out_range, so P, I and D
+     * may each exceed max_out before the final clamp, as in pid_t.
+     */
+    static constexpr float OUT_HEADROOM = 4.0f;
+
+    /**
+     * @brief Constructor, all values in the units of the raw signals.
+     * @param kp Proportional gain (output units per input unit).
+     * @param ki Integral gain (output units per input unit-second).
+     * @param kd Derivative gain (output units per input unit/second).
+     * @param integral_limit Max absolute value of the integral term.
+     * @param max_out Max absolute value of the final output.
+     * @param deadband Error deadband; the step is skipped if
+     * |error| <= deadband.
+     * @param dt Fixed loop period in seconds.
+     * @param in_range Input full scale, Q31 1.0 (e.g. 8192 counts).
+     * @param out_range Output full scale in raw units (e.g. 16384).
+     */
+    pid_q31_t(float kp, float ki, float kd, float integral_limit,
+              float max_out, float deadband, float dt, float in_range,
+              float out_range);
+
+    /**
+     * @brief Calculates the output from Q31 reference and measurement.
+     * @return Output as a Q31 fraction of OUT_HEADROOM * out_range.
+     */
+    q31_t calculate(q31_t ref, q31_t measure);
+
+    /**
+     * @brief Calculates the output from raw reference and measurement.
+     * @return Output in raw units, saturated to int16 (motor current).
+     */
+    int16_t calculate_raw(int32_t ref, int32_t measure);
+
+    /**
+     * @brief Clears the integral and derivative state.
+     */
+    void clear();
+
+    // --- Raw-unit conversions, precomputed at construction ---
+    [[nodiscard]] q31_t raw_to_q31(int32_t raw) const;
+    [[nodiscard]] int32_t q31_to_raw(q31_t value) const;
+
+    // --- Getters ---
+    [[nodiscard]] q31_t get_output_q31() const
+    {
+        return _output;
+    }
+    [[nodiscard]] float get_output() const;
+    [[nodiscard]] float get_i_out() const;
+    [[nodiscard]] q31_t get_error_q31() const
+    {
+        return _err;
+    }
+
+  private:
+    /**
+     * @brief Gain as a Q31 mantissa and a left shift, k * 2^shift.
+     */
+    struct gain_t
+    {
+        q31_t k;
+        uint8_t shift;
+    };
+
+    static gain_t make_gain(float gain);
+    static q31_t to_q31(float value);
+    static q31_t mul(const gain_t &gain, q31_t x);
+
+    // Configuration
+    gain_t _kp, _ki, _kd;     ///< Normalized, ki * dt and kd / dt folded in
+    q31_t _integral_limit;
+    q31_t _max_out;
+    q31_t _deadband;
+    int64_t _in_gain;         ///< Raw input to Q31, 2^31 / in_range
+    int64_t _out_range;       ///< Q31 to raw output, full scale
+    float _out_scale;         ///< Q31 to float output, full scale / 2^31
+
+    // State
+    q31_t _err      = 0;
+    q31_t _last_err = 0;
+    q31_t _i_out    = 0;
+    q31_t _output   = 0;
+};
+
+} // namespace pyro
+
+#endif // __PYRO_ALGO_PID_Q31_H__
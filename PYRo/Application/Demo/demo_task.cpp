@@ -19,6 +19,7 @@ extern "C"
     extern void pyro_wheel_demo(void *arg);
     extern void pyro_controller_demo(void *arg);
     extern void pyro_vofa_demo(void *arg);
+    extern void pyro_pid_bench_demo(void *arg);
     extern void IMU_task(void *argument);
     extern void referee_task(void *arg);
     void start_demo_task(void const *argument)
@@ -49,6 +50,10 @@ extern "C"
         xTaskCreate(pyro_shoot_demo, "pyro_shoot_demo", 512, nullptr,
                     configMAX_PRIORITIES - 2, nullptr);
 #endif
+#if PID_BENCH_DEMO_EN
+        xTaskCreate(pyro_pid_bench_demo, "pyro_pid_bench_demo", 512, nullptr,
+                    tskIDLE_PRIORITY + 1, nullptr);
+#endif
 #if IMU_DEMO_EN
         xTaskCreate(IMU_task, "IMU_task", 512, nullptr,
                     configMAX_PRIORITIES - 2, nullptr);
@@ -3,6 +3,7 @@
 #include "cmsis_os.h"
 #include "fdcan.h"
 #include "pyro_can_drv.h"
+#include "pyro_dji_motor_drv.h"
 #include "pyro_chassis_drv.h"
 #include "pyro_yaw_drv.h"
 #include "pyro_rw_lock.h"
@@ -151,6 +152,7 @@ extern "C"
 
             yaw_drv_1->set_radian(0);
             chassis_drv->chassis_control();
+            pyro::dji_motor_tx_frame_pool_t::get_instance()->commit();
 
             vTaskDelay(1);
         }
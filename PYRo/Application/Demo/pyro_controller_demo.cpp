@@ -7,7 +7,7 @@
 
 #include "pyro_position_controller.h"
 #include "pyro_dm_motor_drv.h"
-#include "pyro_pid_ctrl.h"
+#include "pyro_algo_pid.h"
 
 #include "pyro_dr16_rc_drv.h"
 #include "pyro_rc_base_drv.h"
@@ -22,7 +22,7 @@ extern "C"
 
     pyro::position_controller_t *ctrl;
     pyro::dm_motor_drv_t *motor;
-    pyro::pid_ctrl_t *spd_pid,*pos_pid;
+    pyro::pid_t *spd_pid,*pos_pid;
     float rot;
 
     float angle=0;
@@ -53,19 +53,18 @@ extern "C"
         motor->set_rotate_range(-20, 20);
         motor->set_torque_range(-10, 10);
         
-        spd_pid   = new pyro::pid_ctrl_t(1.0f, 0.1f, 0.0f);
-        spd_pid->set_output_limits(10.0f);
-        spd_pid->set_integral_limits(5.0f);
-
-        pos_pid   = new pyro::pid_ctrl_t(1.6f, 0.0f, 0.0f);
-        pos_pid->set_output_limits(20.0f);
-        pos_pid->set_integral_limits(5.0f);
+        // kp, ki, kd, integral_limit, max_out
+        spd_pid   = new pyro::pid_t(1.0f, 0.1f, 0.0f, 5.0f, 10.0f);
+        pos_pid   = new pyro::pid_t(1.6f, 0.0f, 0.0f, 5.0f, 20.0f);
 
         ctrl  = new pyro::position_controller_t(
             motor, pos_pid, spd_pid);
         ctrl->set_target(-1.0f);
         vTaskDelay(1000);
         motor->enable();
+        TickType_t last_wake = xTaskGetTickCount();
+        // One period back, so the first step already gets dt = 1 tick
+        TickType_t last_ctrl = last_wake - 1;
         for(;;)
         {
 
@@ -83,8 +82,12 @@ extern "C"
 
             ctrl->set_target(angle);
 
-            ctrl->control(0.001f);
-            vTaskDelay(1);
+            // dt in whole ticks: exact, and longer if the loop overran
+            const TickType_t now = xTaskGetTickCount();
+            ctrl->control(static_cast<float>(now - last_ctrl) /
+                          static_cast<float>(configTICK_RATE_HZ));
+            last_ctrl = now;
+            vTaskDelayUntil(&last_wake, 1);
         }
     }
 }
@@ -75,6 +75,7 @@ extern "C"
             m3508_drv_2->send_torque(0.2);
             m3508_drv_3->send_torque(0.2);
             m3508_drv_4->send_torque(0.2);
+            pyro::dji_motor_tx_frame_pool_t::get_instance()->commit();
 
             vTaskDelay(1);
         }
@@ -0,0 +1,127 @@
+#include "pyro_core_config.h"
+#if PID_BENCH_DEMO_EN
+
+#include "cmsis_os.h"
+#include "main.h" // For DWT registers
+
+#include "pyro_algo_pid.h"
+#include "pyro_algo_pid_policy.h"
+#include "pyro_algo_pid_q31.h"
+#include "pyro_uart_drv.h"
+
+#include <cstdio>
+
+/**
+ * @brief Cycles per calculate() of pid_t against policy_pid_t in the chassis
+ * and gimbal configurations. Both sides run the DWT-timed overload on the
+ * same measurement sweep, with the scheduler suspended so a context switch
+ * does not land in one side only. One FireWater line per configuration
+ * every second: "name:pid_t_cycles,policy_cycles". The "pid_q31" line
+ * compares a fixed-dt float current loop with pid_q31_t on raw units.
+ */
+namespace
+{
+constexpr uint16_t BENCH_CALLS = 1000;
+constexpr float DT              = 0.001f; // Fixed-dt loops, 1 kHz
+
+volatile float bench_sink;
+
+template <typename Pid> uint32_t bench(Pid &pid)
+{
+    float measure       = 0.0f;
+    const uint32_t from = DWT->CYCCNT;
+    for (uint16_t i = 0; i < BENCH_CALLS; i++)
+    {
+        measure += 0.01f * (pid.calculate(10.0f, measure) - measure);
+    }
+    const uint32_t cycles = DWT->CYCCNT - from;
+    bench_sink            = measure;
+    return cycles / BENCH_CALLS;
+}
+
+uint32_t bench_float_raw(pyro::pid_t &pid, const float dt)
+{
+    int32_t measure     = 0;
+    const uint32_t from = DWT->CYCCNT;
+    for (uint16_t i = 0; i < BENCH_CALLS; i++)
+    {
+        const auto out = static_cast<int16_t>(
+            pid.calculate(1000.0f, static_cast<float>(measure), dt));
+        measure += (out - measure) >> 4;
+    }
+    const uint32_t cycles = DWT->CYCCNT - from;
+    bench_sink            = static_cast<float>(measure);
+    return cycles / BENCH_CALLS;
+}
+
+uint32_t bench_q31_raw(pyro::pid_q31_t &pid)
+{
+    int32_t measure     = 0;
+    const uint32_t from = DWT->CYCCNT;
+    for (uint16_t i = 0; i < BENCH_CALLS; i++)
+    {
+        measure += (pid.calculate_raw(1000, measure) - measure) >> 4;
+    }
+    const uint32_t cycles = DWT->CYCCNT - from;
+    bench_sink            = static_cast<float>(measure);
+    return cycles / BENCH_CALLS;
+}
+
+void report(pyro::uart_drv_t *uart, const char *name, const uint32_t flag,
+            const uint32_t policy)
+{
+    char line[48];
+    const int len = snprintf(line, sizeof(line), "%s:%lu,%lu\n", name,
+                             static_cast<unsigned long>(flag),
+                             static_cast<unsigned long>(policy));
+    if (len > 0 && len < static_cast<int>(sizeof(line)))
+    {
+        uart->write(reinterpret_cast<const uint8_t *>(line),
+                    static_cast<uint16_t>(len));
+    }
+}
+} // namespace
+
+extern "C" void pyro_pid_bench_demo(void *arg)
+{
+    pyro::uart_drv_t *uart =
+        pyro::uart_drv_t::get_instance(pyro::uart_drv_t::uart1);
+
+    // Wheel speed loop
+    pyro::pid_t chassis_flag(24.0f, 0.1f, 0.0f, 5.0f, 100.0f);
+    pyro::chassis_pid_t chassis_policy({24.0f, 0.1f, 0.0f, 100.0f, 5.0f});
+
+    // Gimbal speed loop
+    pyro::pid_t gimbal_flag(
+        2.0f, 5.0f, 0.05f, 10.0f, 30.0f, 50.0f, 100.0f, 0,
+        pyro::pid_t::INTEGRAL_LIMIT | pyro::pid_t::DERIVATIVE_ON_MEASUREMENT |
+            pyro::pid_t::OUTPUT_FILTER | pyro::pid_t::DERIVATIVE_FILTER);
+    pyro::gimbal_pid_t gimbal_policy(
+        {2.0f, 5.0f, 0.05f, 30.0f, 10.0f, 0.0f, 0.0f, 0.0f, 50.0f, 100.0f});
+
+    // M3508 speed loop at 1 kHz: rpm in, current (+-16384) out
+    pyro::pid_t current_flag(16000.0f, 8000.0f, 5.0f, 10.0f, 200.0f, 0.0f,
+                             0.0f, 0.0f, 0.0f, 0.0f, 0,
+                             pyro::pid_t::INTEGRAL_LIMIT);
+    pyro::pid_q31_t current_q31(10.0f, 200.0f, 0.0f, 8000.0f, 16000.0f, 5.0f,
+                                DT, 16384.0f, 16384.0f);
+
+    while (true)
+    {
+        vTaskSuspendAll();
+        const uint32_t chassis_flag_cyc   = bench(chassis_flag);
+        const uint32_t chassis_policy_cyc = bench(chassis_policy);
+        const uint32_t gimbal_flag_cyc    = bench(gimbal_flag);
+        const uint32_t gimbal_policy_cyc  = bench(gimbal_policy);
+        const uint32_t current_flag_cyc   = bench_float_raw(current_flag, DT);
+        const uint32_t current_q31_cyc    = bench_q31_raw(current_q31);
+        xTaskResumeAll();
+
+        report(uart, "pid_chassis", chassis_flag_cyc, chassis_policy_cyc);
+        report(uart, "pid_gimbal", gimbal_flag_cyc, gimbal_policy_cyc);
+        report(uart, "pid_q31", current_flag_cyc, current_q31_cyc);
+        vTaskDelay(1000);
+    }
+}
+
+#endif
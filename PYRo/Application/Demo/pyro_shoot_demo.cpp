@@ -3,6 +3,7 @@
 #include "cmsis_os.h"
 #include "fdcan.h"
 #include "pyro_can_drv.h"
+#include "pyro_dji_motor_drv.h"
 #include "pyro_shoot_17mm_control.h"
 
 #define FRIC_RADIUS 0.03f
@@ -92,6 +93,7 @@ extern "C"
             shoot_drv->update_feedback();
             shoot_drv->set_control();
             shoot_drv->control();
+            pyro::dji_motor_tx_frame_pool_t::get_instance()->commit();
 
             vTaskDelay(1);
         }
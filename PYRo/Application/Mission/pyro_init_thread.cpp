@@ -12,8 +12,9 @@ extern "C"
     {
         pyro::dwt_drv_t::init(480); // Initialize DWT at 480 MHz
 
+        // Referee link at 921600 baud, no re-arm gap between frames
         pyro::uart_drv_t::get_instance(pyro::uart_drv_t::uart1)
-            ->enable_rx_dma();
+            ->enable_rx_circular();
         pyro::uart_drv_t::get_instance(pyro::uart_drv_t::uart5)
             ->enable_rx_dma();
         pyro::uart_drv_t::get_instance(pyro::uart_drv_t::uart7)
@@ -42,8 +42,8 @@ static float angle_correction(float target, float feedback,float max)
 }
 void position_controller_t::control(float dt)
 {
-    _target_rot = _pos_pid->compute(angle_correction(_target_pos, _feedback_pos, pyro::PI), _feedback_pos, dt);
-    _control_value = _rot_pid->compute(_target_rot, _feedback_rot, dt);
+    _target_rot = _pos_pid->calculate(angle_correction(_target_pos, _feedback_pos, pyro::PI), _feedback_pos, dt);
+    _control_value = _rot_pid->calculate(_target_rot, _feedback_rot, dt);
     _motor->send_torque(_control_value);
 }
 
@@ -22,7 +22,7 @@ namespace pyro
 
     void velocity_controller_t::control(float dt)
     {
-        _control_value = _spd_pid->compute(_target_spd, _feedback_spd, dt);
+        _control_value = _spd_pid->calculate(_target_spd, _feedback_spd, dt);
         _motor->send_torque(_control_value);
     }
 
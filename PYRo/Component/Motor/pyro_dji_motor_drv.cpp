@@ -11,8 +11,12 @@ dji_motor_tx_frame_t::dji_motor_tx_frame_t(can_hub_t::which_can which,
 {
     _can = can_hub_t::get_instance()->hub_get_can_obj(_key.second);
     _register_list.fill(0);
-    _update_list.fill(0);
+    for (auto &update : _update_list)
+    {
+        update = 0;
+    }
     _value_list.fill(0);
+    _stale_count.fill(0);
 }
 
 dji_motor_tx_frame_t::~dji_motor_tx_frame_t()
@@ -33,30 +37,111 @@ dji_motor_tx_frame_t::get_key(void)
     return _key;
 }
 
-status_t dji_motor_tx_frame_t::update_value(uint8_t id,int16_t value)
+/**
+ * @brief Stages the command of one motor, sent by the next commit(). In
+ * auto-send mode the frame goes out once every registered slot is staged.
+ */
+status_t dji_motor_tx_frame_t::update_value(uint8_t id, int16_t value)
 {
     if (_register_list[id % 4] == 0)
         return PYRO_ERROR;
-    _value_list[id % 4]  = value;
-    _update_list[id % 4] = 1;
+    UBaseType_t irq_state = taskENTER_CRITICAL_FROM_ISR();
+    _value_list[id % 4]   = value;
+    _update_list[id % 4]  = 1;
+    taskEXIT_CRITICAL_FROM_ISR(irq_state);
+    if (_auto_send && is_complete())
+        return commit();
+    return PYRO_OK;
+}
+
+bool dji_motor_tx_frame_t::is_dirty(void) const
+{
     for (uint8_t i = 0; i < 4; i++)
     {
-        if (_register_list[i])
-        {
-            if (!_update_list[i])
-                return PYRO_ERROR;
-        }
+        if (_register_list[i] && _update_list[i])
+            return true;
+    }
+    return false;
+}
+
+bool dji_motor_tx_frame_t::is_complete(void) const
+{
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        if (_register_list[i] && !_update_list[i])
+            return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Packs all slots and queues the frame. Registered slots without a
+ * new value are flagged stale and filled according to the stale policy.
+ * Does nothing if no slot was staged since the previous commit.
+ *
+ * Packing and queueing are one critical section, so concurrent commits
+ * send each staged set once and in staging order.
+ */
+status_t dji_motor_tx_frame_t::commit(void)
+{
+    if (nullptr == _can)
+        return PYRO_ERROR;
+
+    UBaseType_t irq_state = taskENTER_CRITICAL_FROM_ISR();
+    if (!is_dirty())
+    {
+        taskEXIT_CRITICAL_FROM_ISR(irq_state);
+        return PYRO_OK;
     }
     std::array<uint8_t, 8> data;
-    data.fill(0);
+    uint8_t stale_mask = 0;
     for (uint8_t i = 0; i < 4; i++)
     {
-        _update_list[i] = 0 ;
-        data[i * 2]     = (_value_list[i] & 0xff00) >> 8;
-        data[i * 2 + 1] = _value_list[i] & 0xff;
+        int16_t value = _value_list[i];
+        if (_register_list[i] && !_update_list[i])
+        {
+            stale_mask |= 1U << i;
+            _stale_count[i]++;
+            if (STALE_ZERO == _stale_policy)
+                value = 0;
+        }
+        _update_list[i] = 0;
+        data[i * 2]     = (value & 0xff00) >> 8;
+        data[i * 2 + 1] = value & 0xff;
     }
-    _can->send_msg(_key.first, data.data());
-    return PYRO_OK;
+    _stale_mask = stale_mask;
+    const status_t status =
+        _can->send_msg(_key.first, data.data(), can_drv_t::TX_PRIO_MOTOR);
+    taskEXIT_CRITICAL_FROM_ISR(irq_state);
+    return status;
+}
+
+void dji_motor_tx_frame_t::set_stale_policy(stale_policy_t policy)
+{
+    _stale_policy = policy;
+}
+
+uint8_t dji_motor_tx_frame_t::get_stale_mask(void) const
+{
+    return _stale_mask;
+}
+
+uint32_t dji_motor_tx_frame_t::get_stale_count(uint8_t id) const
+{
+    return _stale_count[id % 4];
+}
+
+can_drv_t *dji_motor_tx_frame_t::get_can(void) const
+{
+    return _can;
+}
+
+/**
+ * @brief Auto-send on a complete frame (true), or only on commit() (false).
+ */
+void dji_motor_tx_frame_t::set_auto_send(bool enable)
+{
+    _auto_send = enable;
 }
 
 dji_motor_tx_frame_pool_t::dji_motor_tx_frame_pool_t(void)
@@ -91,12 +176,78 @@ dji_motor_tx_frame_pool_t::get_frame(can_hub_t::which_can which, uint32_t id)
     if (frame == nullptr)
     {
         frame = new dji_motor_tx_frame_t(which, id);
+        frame->set_stale_policy(_stale_policy);
+        frame->set_auto_send(!_explicit);
         _frame_list.push_back(frame);
+
+        can_drv_t *can = frame->get_can();
+        uint8_t i      = 0;
+        while (i < _bus_num && _bus_list[i] != can)
+            i++;
+        if (nullptr != can && i == _bus_num && _bus_num < _bus_list.size())
+        {
+            _bus_list[_bus_num++] = can;
+            if (_explicit)
+                can->config_tx_cycle_flush(true);
+        }
     }
     return frame;
 }
 
 
+/**
+ * @brief Commits every dirty frame on all buses, then releases the held
+ * motor queue of each bus. Call once per control tick after all
+ * controllers have staged their output.
+ *
+ * The first call takes over sending: frames stop auto-sending and the
+ * motor buses switch to cycle flush, so from then on this must run every
+ * tick. May be called from several tasks.
+ */
+status_t dji_motor_tx_frame_pool_t::commit(void)
+{
+    if (!_explicit)
+    {
+        UBaseType_t irq_state = taskENTER_CRITICAL_FROM_ISR();
+        const bool take_over  = !_explicit;
+        _explicit             = true;
+        taskEXIT_CRITICAL_FROM_ISR(irq_state);
+        if (take_over)
+        {
+            for (dji_motor_tx_frame_t *frame : _frame_list)
+            {
+                frame->set_auto_send(false);
+            }
+            for (uint8_t i = 0; i < _bus_num; i++)
+            {
+                _bus_list[i]->config_tx_cycle_flush(true);
+            }
+        }
+    }
+
+    status_t status = PYRO_OK;
+    for (dji_motor_tx_frame_t *frame : _frame_list)
+    {
+        if (PYRO_OK != frame->commit())
+            status = PYRO_ERROR;
+    }
+    for (uint8_t i = 0; i < _bus_num; i++)
+    {
+        _bus_list[i]->flush_tx();
+    }
+    return status;
+}
+
+void dji_motor_tx_frame_pool_t::set_stale_policy(
+    dji_motor_tx_frame_t::stale_policy_t policy)
+{
+    _stale_policy = policy;
+    for (dji_motor_tx_frame_t *frame : _frame_list)
+    {
+        frame->set_stale_policy(policy);
+    }
+}
+
 dji_motor_drv_t::dji_motor_drv_t(
     dji_motor_tx_frame_t::register_id_t id,
     can_hub_t::which_can which)
@@ -118,8 +269,8 @@ status_t dji_motor_drv_t::disable()
 
 status_t dji_motor_drv_t::update_feedback()
 {
-    static std::array<uint8_t, 8> data;
-    _feedback_msg->get_data(data);
+    _feedback_msg->read(_feedback);
+    const std::array<uint8_t, 8> &data = _feedback.data;
 
     _current_position = ((float)((uint16_t)((data[0] << 8) | (data[1])))) /
                         8192.0f * 2 * PI;
@@ -5,9 +5,31 @@
 
 namespace pyro
 {
+/**
+ * @brief One DJI command frame (0x200/0x1FF/0x2FE) shared by up to four
+ * motors. Controllers stage values with update_value(), commit() packs and
+ * sends the frame once per control tick.
+ *
+ * Until the pool takes over (see dji_motor_tx_frame_pool_t::commit()), the
+ * frame auto-sends as soon as every registered slot has been staged, so
+ * code that only calls send_torque() keeps transmitting.
+ *
+ * Staging, packing and sending are each done under a critical section, so
+ * controllers in different tasks may share a frame.
+ */
 class dji_motor_tx_frame_t
 {
   public:
+    /**
+     * @brief What commit() sends for a registered slot that was not
+     * updated since the previous commit.
+     */
+    enum stale_policy_t
+    {
+        STALE_HOLD = 0, // Repeat the last staged value
+        STALE_ZERO      // Send zero current
+    };
+
     enum register_id_t
     {
         id_1 = 0,
@@ -28,15 +50,27 @@ class dji_motor_tx_frame_t
     status_t register_id(register_id_t id);
 
     status_t update_value(uint8_t id, int16_t value);
+    status_t commit(void);
+    bool is_dirty(void) const;
+    void set_stale_policy(stale_policy_t policy);
+    uint8_t get_stale_mask(void) const;
+    uint32_t get_stale_count(uint8_t id) const;
+    can_drv_t *get_can(void) const;
+    void set_auto_send(bool enable);
 
   private:
+    bool is_complete(void) const;
+
     _frame_key_t _key;
     can_drv_t *_can;
-    std::array<uint8_t, 8> _data;
+    stale_policy_t _stale_policy = STALE_HOLD;
+    volatile bool _auto_send     = true; // Send once all slots are staged
 
     std::array<uint8_t, 4> _register_list;
-    std::array<uint8_t, 4> _update_list;
+    std::array<volatile uint8_t, 4> _update_list; // Staged since last commit
     std::array<int16_t, 4> _value_list;
+    uint8_t _stale_mask = 0;          // Bit i: slot i was stale last commit
+    std::array<uint32_t, 4> _stale_count; // Stale commits per slot
 };
 
 class dji_motor_tx_frame_pool_t
@@ -45,6 +79,8 @@ class dji_motor_tx_frame_pool_t
     static dji_motor_tx_frame_pool_t *get_instance(void);
     dji_motor_tx_frame_t *get_frame(can_hub_t::which_can which,
                                     uint32_t id);
+    status_t commit(void);
+    void set_stale_policy(dji_motor_tx_frame_t::stale_policy_t policy);
 
   private:
     dji_motor_tx_frame_pool_t(void);
@@ -53,6 +89,11 @@ class dji_motor_tx_frame_pool_t
     operator=(const dji_motor_tx_frame_pool_t &) = delete;
     static dji_motor_tx_frame_pool_t *_instancePtr;
     std::vector<dji_motor_tx_frame_t *> _frame_list;
+    std::array<can_drv_t *, can_hub_t::can_num> _bus_list{}; // Frame buses
+    uint8_t _bus_num = 0;
+    bool _explicit   = false; // commit() has taken over sending
+    dji_motor_tx_frame_t::stale_policy_t _stale_policy =
+        dji_motor_tx_frame_t::STALE_HOLD;
 };
 
 class dji_motor_drv_t : public motor_base_t
@@ -25,7 +25,8 @@ status_t pyro::dm_motor_drv_t::enable()
     data.fill(0xFF);
     data[7] = 0xfc;
     _enable = true;
-    if(PYRO_OK!=_can_drv->send_msg(_can_id, data.data()))
+    if(PYRO_OK!=_can_drv->send_msg(_can_id, data.data(),
+                                   can_drv_t::TX_PRIO_CONTROL))
         return PYRO_ERROR;
     return PYRO_OK;
 }
@@ -36,7 +37,8 @@ status_t dm_motor_drv_t::disable()
     data.fill(0xFF);
     data[7] = 0xfc;
     _enable = false;
-    if(PYRO_OK!=_can_drv->send_msg(_can_id, data.data()))
+    if(PYRO_OK!=_can_drv->send_msg(_can_id, data.data(),
+                                   can_drv_t::TX_PRIO_CONTROL))
         return PYRO_ERROR;
     return PYRO_OK;
 }
@@ -57,8 +59,8 @@ static float uint_to_float(int x_int, float x_min, float x_max, int bits)
 
 status_t pyro::dm_motor_drv_t::update_feedback()
 {
-    std::array<uint8_t, 8> data;
-    _feedback_msg->get_data(data);
+    _feedback_msg->read(_feedback);
+    const std::array<uint8_t, 8> &data = _feedback.data;
     _error_code = static_cast<error_code>(((data[0]>>4)&0x0f));
     uint16_t position = ((uint16_t)((data[1] << 8) | (data[2])));
     uint16_t rotate   = ((uint16_t)((data[3] << 4) | ((data[4] >> 4) & 0x0f)));
@@ -45,6 +45,7 @@ class motor_base_t
     float _current_torque;
 
     can_msg_buffer_t *_feedback_msg;
+    can_msg_buffer_t::snapshot_t _feedback{}; // This motor's read position
 };
 }; // namespace pyro
 
@@ -14,6 +14,7 @@
 
 /* Includes ------------------------------------------------------------------*/
 #include "pyro_dr16_rc_drv.h"
+#include "pyro_profile.h"
 #include "pyro_rw_lock.h"
 #include "task.h" // Needed for xTaskCreate calls
 #include <cstring>
@@ -32,7 +33,8 @@ static constexpr uint16_t DR16_CH_VALUE_OFFSET = 1024;
  *
  * Calls the base class constructor and sets the internal task priority.
  */
-dr16_drv_t::dr16_drv_t(uart_drv_t *dr16_uart) : rc_drv_t(dr16_uart)
+dr16_drv_t::dr16_drv_t(uart_drv_t *dr16_uart)
+    : rc_drv_t(dr16_uart, "dr16")
 {
     _priority = 1;
 }
@@ -74,9 +76,8 @@ void dr16_drv_t::enable()
 {
     // Register the local rc_callback method as the UART RX event handler
     _rc_uart->add_rx_event_callback(
-        [this](uint8_t *buf, uint16_t len,
-               BaseType_t xHigherPriorityTaskWoken) -> bool
-        { return rc_callback(buf, len, xHigherPriorityTaskWoken); },
+        uart_drv_t::rx_event_func::bind<rc_drv_t, &rc_drv_t::rc_callback>(
+            this),
         reinterpret_cast<uint32_t>(this));
 }
 
@@ -195,6 +196,7 @@ void dr16_drv_t::check_ctrl(key_t &key, const uint8_t state)
  */
 void dr16_drv_t::unpack(const dr16_buf_t *dr16_buf)
 {
+    PYRO_PROFILE_SCOPE("dr16_unpack");
     if (PYRO_OK == error_check(dr16_buf))
     {
         _dr16_last_ctrl = _dr16_ctrl; // Save last state
@@ -247,7 +249,7 @@ void dr16_drv_t::unpack(const dr16_buf_t *dr16_buf)
  * @return true if data was buffered and the UART buffer should switch.
  */
 bool dr16_drv_t::rc_callback(uint8_t *buf, uint16_t len,
-                             BaseType_t xHigherPriorityTaskWoken)
+                             BaseType_t *pxHigherPriorityTaskWoken)
 {
     if (len == 18)
     {
@@ -255,8 +257,11 @@ bool dr16_drv_t::rc_callback(uint8_t *buf, uint16_t len,
         // protocol
         if (__builtin_ctz(sequence) >= _priority)
         {
-            xMessageBufferSendFromISR(_rc_msg_buffer, buf, len,
-                                      &xHigherPriorityTaskWoken);
+            if (xMessageBufferSendFromISR(_rc_msg_buffer, buf, len,
+                                          pxHigherPriorityTaskWoken))
+            {
+                _latency.stamp_send(_rc_uart->get_rx_event_ticks());
+            }
             return true;
         }
     }
@@ -282,6 +287,8 @@ void dr16_drv_t::thread()
     {
         // Signal that a packet was received (used for priority management)
         sequence |= (1 << _priority);
+        _latency.stamp_wake();
+        _latency.stamp_discard(); // Only arms the link, not unpacked
     }
 
     // Process packets as long as the sequence bit is set
@@ -292,7 +299,9 @@ void dr16_drv_t::thread()
                                                sizeof(dr16_buf_t), 100);
         if (xReceivedBytes == sizeof(dr16_buf_t))
         {
+            _latency.stamp_wake();
             unpack(&dr16_buf); // Process the packet
+            _latency.stamp_done();
         }
         else if (xReceivedBytes == 0)
         {
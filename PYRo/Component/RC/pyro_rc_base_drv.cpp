@@ -32,8 +32,9 @@ namespace pyro
  * Initializes the pointer to the required UART driver instance.
  *
  * @param uart Pointer to the initialized UART driver.
+ * @param name Name of the receiver's latency path.
  */
-rc_drv_t::rc_drv_t(uart_drv_t *uart)
+rc_drv_t::rc_drv_t(uart_drv_t *uart, const char *name) : _latency(name)
 {
     _rc_uart = uart;
     sequence = 0x80;
@@ -44,6 +45,11 @@ rw_lock &rc_drv_t::get_lock() const
     return *_lock;
 }
 
+const latency_path_t &rc_drv_t::get_latency() const
+{
+    return _latency;
+}
+
 
 /* Destructor ----------------------------------------------------------------*/
 /**
@@ -19,9 +19,13 @@
 /* Includes ------------------------------------------------------------------*/
 #include "pyro_uart_drv.h" // Dependency on the UART driver
 #include "message_buffer.h" // FreeRTOS Message Buffer definitions
+#include "pyro_latency.h"
 #include "pyro_rw_lock.h"
 #include "task.h"          // FreeRTOS Task definitions
 
+#include <functional> // cmd_func
+#include <vector>     // _cmd_funcs
+
 namespace pyro
 {
 
@@ -45,7 +49,7 @@ class rc_drv_t
 
     /* Public Methods - Construction and Lifecycle
      * -----------------------------*/
-    explicit rc_drv_t(uart_drv_t *uart);
+    explicit rc_drv_t(uart_drv_t *uart, const char *name = "rc");
     virtual ~rc_drv_t();
 
     /* Public Methods - Pure Virtual Interface
@@ -56,6 +60,10 @@ class rc_drv_t
     virtual void thread()                            = 0;
     virtual void config_rc_cmd(const cmd_func &func) = 0;
     rw_lock &get_lock() const;
+    /**
+     * @brief RX event -> message buffer -> task -> command callbacks.
+     */
+    const latency_path_t &get_latency() const;
 
     /**
      * @brief Callback function executed by the underlying UART driver in ISR
@@ -65,12 +73,13 @@ class rc_drv_t
      * classes.
      * @param buf Pointer to the received data buffer.
      * @param len Length of the received data.
-     * @param xHigherPriorityTaskWoken Flag for FreeRTOS context switching.
+     * @param pxHigherPriorityTaskWoken Flag for FreeRTOS context switching,
+     * the UART driver yields on it after all callbacks ran.
      * @return true if the buffer was processed and should be switched by the
      * UART driver.
      */
     virtual bool rc_callback(uint8_t *buf, uint16_t len,
-                             BaseType_t xHigherPriorityTaskWoken) = 0;
+                             BaseType_t *pxHigherPriorityTaskWoken) = 0;
 
 
   protected:
@@ -85,6 +94,7 @@ class rc_drv_t
     ///< Handle for the FreeRTOS processing task.
     uart_drv_t *_rc_uart; ///< Pointer to the underlying UART driver instance.
     uint8_t _priority{};  ///< Priority of the associated FreeRTOS task.
+    latency_path_t _latency; ///< Input-to-command latency of this receiver.
 
 };
 } // namespace pyro
@@ -33,7 +33,8 @@ static constexpr uint16_t VT03_CH_VALUE_OFFSET = 1024;
  *
  * Calls the base class constructor and sets the internal task priority.
  */
-vt03_drv_t::vt03_drv_t(uart_drv_t *vt03_uart) : rc_drv_t(vt03_uart)
+vt03_drv_t::vt03_drv_t(uart_drv_t *vt03_uart)
+    : rc_drv_t(vt03_uart, "vt03")
 {
     _priority = 0;
 }
@@ -68,16 +69,23 @@ status_t vt03_drv_t::init()
 /**
  * @brief Enables the VT03 receiver.
  *
- * Adds the ISR callback to the UART driver and sets the protocol's sequence
- * bit.
+ * The link is shared with the referee system, so the receiver registers a
+ * demux route (sync bytes 0xA9 0x53, fixed length) on the UART instead of a
+ * plain RX callback and only ever sees its own frames.
  */
 void vt03_drv_t::enable()
 {
-    // Register the local rc_callback method as the UART RX event handler
-    _rc_uart->add_rx_event_callback(
-        [this](uint8_t *buf, uint16_t len,
-               BaseType_t xHigherPriorityTaskWoken) -> bool
-        { return rc_callback(buf, len, xHigherPriorityTaskWoken); },
+    uart_drv_t::demux_proto_t proto{};
+    proto.sync[0]  = 0xA9;
+    proto.sync[1]  = 0x53;
+    proto.sync_len = 2;
+    proto.len_base = sizeof(vt03_buf_t);
+    proto.min_len  = sizeof(vt03_buf_t);
+    proto.max_len  = sizeof(vt03_buf_t);
+    _rc_uart->add_demux_route(
+        proto,
+        uart_drv_t::demux_func::bind<vt03_drv_t, &vt03_drv_t::frame_callback>(
+            this),
         reinterpret_cast<uint32_t>(this));
 }
 
@@ -91,7 +99,7 @@ void vt03_drv_t::disable()
     // Clear the priority bit in the base class static sequence variable
     sequence &= ~(1 << _priority);
     // Remove the registered callback using the instance address as the owner ID
-    _rc_uart->remove_rx_event_callback(reinterpret_cast<uint32_t>(this));
+    _rc_uart->remove_demux_route(reinterpret_cast<uint32_t>(this));
 }
 
 /* Data Processing - Error Check ---------------------------------------------*/
@@ -252,6 +260,25 @@ void vt03_drv_t::unpack(const vt03_buf_t *vt03_buf)
 }
 
 /* Interrupt Service Routine (ISR) Callback ----------------------------------*/
+/**
+ * @brief Called by the UART demux with one VT03 frame (ISR context).
+ *
+ * The frame is only copied when it wraps around the end of the RX ring.
+ */
+void vt03_drv_t::frame_callback(const uart_drv_t::rx_span_t &frame,
+                                BaseType_t *pxHigherPriorityTaskWoken)
+{
+    uint8_t linear[sizeof(vt03_buf_t)];
+    uint8_t *buf = frame.first;
+    if (frame.second_len)
+    {
+        memcpy(linear, frame.first, frame.first_len);
+        memcpy(linear + frame.first_len, frame.second, frame.second_len);
+        buf = linear;
+    }
+    rc_callback(buf, frame.size(), pxHigherPriorityTaskWoken);
+}
+
 /**
  * @brief Called by the UART driver upon an RX event (ISR context).
  *
@@ -260,7 +287,7 @@ void vt03_drv_t::unpack(const vt03_buf_t *vt03_buf)
  * @return true if data was buffered and the UART buffer should switch.
  */
 bool vt03_drv_t::rc_callback(uint8_t *buf, uint16_t len,
-                             BaseType_t xHigherPriorityTaskWoken)
+                             BaseType_t *pxHigherPriorityTaskWoken)
 {
     if (len == sizeof(vt03_buf_t))
     {
@@ -268,8 +295,11 @@ bool vt03_drv_t::rc_callback(uint8_t *buf, uint16_t len,
         {
             if (__builtin_ctz(sequence) >= _priority)
             {
-                xMessageBufferSendFromISR(_rc_msg_buffer, buf, len,
-                                          &xHigherPriorityTaskWoken);
+                if (xMessageBufferSendFromISR(_rc_msg_buffer, buf, len,
+                                              pxHigherPriorityTaskWoken))
+                {
+                    _latency.stamp_send(_rc_uart->get_rx_event_ticks());
+                }
                 return true;
             }
         }
@@ -296,6 +326,8 @@ void vt03_drv_t::thread()
     {
         // Signal that a packet was received (used for priority management)
         sequence |= (1 << _priority);
+        _latency.stamp_wake();
+        _latency.stamp_discard(); // Only arms the link, not unpacked
     }
 
     // Process packets as long as the sequence bit is set
@@ -306,7 +338,9 @@ void vt03_drv_t::thread()
                                                sizeof(vt03_buf_t), 120);
         if (xReceivedBytes == sizeof(vt03_buf_t))
         {
+            _latency.stamp_wake();
             unpack(&vt03_buf); // Process the packet
+            _latency.stamp_done();
         }
         else if (xReceivedBytes == 0)
         {
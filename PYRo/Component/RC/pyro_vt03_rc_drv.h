@@ -187,7 +187,12 @@ class vt03_drv_t : public rc_drv_t
      * Receives raw UART data and forwards it to the FreeRTOS message buffer.
      */
     bool rc_callback(uint8_t *buf, uint16_t len,
-                     BaseType_t xHigherPriorityTaskWoken) override;
+                     BaseType_t *pxHigherPriorityTaskWoken) override;
+    /**
+     * @brief Demux route of the shared UART, one complete VT03 frame.
+     */
+    void frame_callback(const uart_drv_t::rx_span_t &frame,
+                        BaseType_t *pxHigherPriorityTaskWoken);
 
     /* Private Methods - Processing
      * --------------------------------------------*/
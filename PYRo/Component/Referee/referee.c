@@ -1,6 +1,7 @@
 #include "referee.h"
 #include "CRC8_CRC16.h"
 #include "protocol.h"
+#include "pyro_profile.h"
 #include "stdio.h"
 #include "string.h"
 
@@ -26,6 +27,8 @@ void referee_data_solve(uint8_t *frame)
 
     uint8_t index = 0;
 
+    PYRO_PROFILE_BEGIN(solve, "referee_data_solve");
+
     memcpy(&referee_receive_header, frame, sizeof(frame_header_struct_t));
 
     index += sizeof(frame_header_struct_t);
@@ -138,6 +141,7 @@ void referee_data_solve(uint8_t *frame)
             break;
         }
     }
+    PYRO_PROFILE_END(solve);
 }
 
 
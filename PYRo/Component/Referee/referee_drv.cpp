@@ -1,4 +1,5 @@
 #include "cmsis_os.h"
+#include "pyro_latency.h"
 #include "pyro_uart_drv.h"
 
 #include <cstdio>
@@ -7,21 +8,52 @@
 extern "C" void referee_usart_task(void *argument);
 extern "C" void referee_rx_handler(uint8_t *buf, uint16_t Size);
 
-bool referee_uart_callback(uint8_t *data, uint16_t size,
-                           BaseType_t xHigherPriorityTaskWoken)
+// RX event -> referee FIFO -> referee task poll -> referee_data_solve()
+static pyro::latency_path_t referee_latency("referee");
+
+// Looked up once in referee_init(). get_instance() suspends the scheduler and
+// must not be called from the RX callback, which runs in the UART ISR.
+static pyro::uart_drv_t *referee_uart = nullptr;
+
+// One referee frame: SOF 0xA5, data length, seq, CRC8, cmd id, data, CRC16.
+// The unpacker still checks both CRCs.
+void referee_uart_callback(const pyro::uart_drv_t::rx_span_t &span,
+                           BaseType_t *pxHigherPriorityTaskWoken)
 {
-    if (0xA5 == data[0])
+    referee_rx_handler(span.first, span.first_len);
+    if (span.second_len)
     {
-        referee_rx_handler(data, size);
-        return true;
+        referee_rx_handler(span.second, span.second_len);
     }
-    return false;
+    referee_latency.stamp_send(referee_uart->get_rx_event_ticks());
+}
+
+// The task drains the whole FIFO per poll, so every queued frame is picked
+// up at once and closed when the drain returns.
+extern "C" void referee_latency_wake()
+{
+    referee_latency.stamp_wake(pyro::latency_path_t::STAMP_DEPTH);
+}
+
+extern "C" void referee_latency_done()
+{
+    referee_latency.stamp_done();
 }
 
 extern "C" void referee_init()
 {
-    pyro::uart_drv_t::get_instance(pyro::uart_drv_t::uart1)
-        ->add_rx_event_callback(referee_uart_callback, 0x20);
+    pyro::uart_drv_t::demux_proto_t proto{};
+    proto.sync[0]    = 0xA5;
+    proto.sync_len   = 1;
+    proto.len_offset = 1; // Little-endian data length
+    proto.len_size   = 2;
+    proto.len_base   = 9; // Header 5 + cmd id 2 + CRC16 2
+    proto.min_len    = 9;
+    proto.max_len    = 128;
+    referee_uart = pyro::uart_drv_t::get_instance(pyro::uart_drv_t::uart1);
+    referee_uart->add_demux_route(
+        proto, pyro::uart_drv_t::demux_func::bind<&referee_uart_callback>(),
+        0x20);
 }
 
 extern "C" void referee_task(void *arg)
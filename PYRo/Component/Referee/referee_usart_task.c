@@ -52,6 +52,8 @@ uint8_t referee_fifo_buf[REFEREE_FIFO_BUF_LENGTH];
 unpack_data_t referee_unpack_obj;
 	
 extern void referee_init();
+extern void referee_latency_wake(void);
+extern void referee_latency_done(void);
 
 void referee_usart_task(void* argument)
 {
@@ -60,7 +62,9 @@ void referee_usart_task(void* argument)
     referee_init();
     while(1)
     {
+        referee_latency_wake();
         referee_unpack_fifo_data();
+        referee_latency_done();
         vTaskDelay(10);
     }
 
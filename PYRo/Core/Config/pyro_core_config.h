@@ -12,6 +12,7 @@
 #define CONTROL_DEMO_EN 0
 #define IMU_DEMO_EN 0
 #define referee_DEMO_EN 1
+#define PID_BENCH_DEMO_EN 0 // pid_t vs policy_pid_t cycles on uart1
 
 #endif
 
@@ -19,6 +20,8 @@
 
 #define VOFA_DEBUG_EN 1
 #define JCOM_DEBUG_EN 0
+#define PROFILE_DEBUG_EN 0 // Cycle profiler, streams on uart1 like VOFA
+#define RTOS_STAT_DEBUG_EN 0 // Per-task CPU/stack report on uart1
 
 #endif
 
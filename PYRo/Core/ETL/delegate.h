@@ -0,0 +1,74 @@
+#ifndef DELEGATE_H
+#define DELEGATE_H
+namespace pyro
+{
+template <typename Sig> class delegate_t;
+
+/**
+ * @brief Non-owning callable made of an object pointer and a stub function.
+ *
+ * Unlike std::function it never allocates and is trivially copyable, so a
+ * table of delegates can be filled from a task and called from an ISR. The
+ * target is fixed at compile time through a template argument:
+ *
+ *   delegate_t<bool(int)>::bind<&free_func>();
+ *   delegate_t<bool(int)>::bind<foo_t, &foo_t::method>(&foo);
+ *
+ * Member functions may be virtual. The bound object must outlive the
+ * delegate.
+ */
+template <typename R, typename... Args> class delegate_t<R(Args...)>
+{
+  public:
+    constexpr delegate_t() = default;
+
+    template <R (*Func)(Args...)> static delegate_t bind()
+    {
+        return delegate_t(nullptr, &func_stub<Func>);
+    }
+
+    template <typename T, R (T::*Method)(Args...)>
+    static delegate_t bind(T *obj)
+    {
+        return delegate_t(obj, &method_stub<T, Method>);
+    }
+
+    R operator()(Args... args) const
+    {
+        return _stub(_obj, args...);
+    }
+
+    bool valid() const
+    {
+        return nullptr != _stub;
+    }
+
+    bool operator==(const delegate_t &other) const
+    {
+        return _obj == other._obj && _stub == other._stub;
+    }
+
+  private:
+    using stub_t = R (*)(void *, Args...);
+
+    constexpr delegate_t(void *obj, const stub_t stub) : _obj(obj), _stub(stub)
+    {
+    }
+
+    template <R (*Func)(Args...)> static R func_stub(void *, Args... args)
+    {
+        return Func(args...);
+    }
+
+    template <typename T, R (T::*Method)(Args...)>
+    static R method_stub(void *obj, Args... args)
+    {
+        return (static_cast<T *>(obj)->*Method)(args...);
+    }
+
+    void *_obj{};
+    stub_t _stub{};
+};
+}; // namespace pyro
+
+#endif
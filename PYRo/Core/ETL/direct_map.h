@@ -0,0 +1,145 @@
+#ifndef DIRECT_MAP_H
+#define DIRECT_MAP_H
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+namespace pyro
+{
+/**
+ * @brief Fixed-capacity map for small dense integer keys (e.g. 11-bit CAN IDs).
+ *
+ * Every possible key owns one byte in an index table that holds the slot
+ * number of its value (0 = not present). A lookup is therefore a single table
+ * load, independent of how many keys are stored, and never allocates.
+ *
+ * insert()/erase() are meant for task context. lookup() may be called from an
+ * ISR: a slot is fully written before its index is published, and the index
+ * is withdrawn before a slot is released.
+ *
+ * @tparam V        Value type. V() is returned for absent keys.
+ * @tparam KeyRange Number of valid keys, must be a power of two.
+ * @tparam Capacity Maximum number of stored keys.
+ */
+template <typename V, size_t KeyRange, size_t Capacity> class direct_map_t
+{
+    static_assert((KeyRange & (KeyRange - 1)) == 0,
+                  "KeyRange must be a power of two");
+    static_assert(Capacity < 0xFF, "slot index is stored in uint8_t");
+
+  public:
+    constexpr static size_t _max_size  = Capacity;
+    constexpr static size_t _key_range = KeyRange;
+
+    direct_map_t()
+    {
+        clear();
+    }
+
+    /**
+     * @brief O(1) lookup, ISR-safe. Returns V() if the key is not present
+     * or out of range, rather than aliasing it onto another key's slot.
+     */
+    V lookup(const size_t key) const
+    {
+        if (key >= KeyRange)
+        {
+            return V();
+        }
+        return _values[_index[key]];
+    }
+
+    bool exist(const size_t key) const
+    {
+        return key < KeyRange && _index[key] != 0;
+    }
+
+    /**
+     * @brief Inserts a new key.
+     * @return false if the key is out of range, already present or the map
+     * is full.
+     */
+    bool insert(const size_t key, const V &value)
+    {
+        if (key >= KeyRange || _index[key] != 0 || _size >= Capacity)
+        {
+            return false;
+        }
+        for (size_t slot = 1; slot <= Capacity; slot++)
+        {
+            if (!_used[slot])
+            {
+                _keys[slot]   = static_cast<uint16_t>(key);
+                _values[slot] = value;
+                _used[slot]   = true;
+                _size++;
+                // Slot must be complete before an ISR can reach it
+                std::atomic_signal_fence(std::memory_order_release);
+                _index[key] = static_cast<uint8_t>(slot);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool erase(const size_t key)
+    {
+        if (!exist(key))
+        {
+            return false;
+        }
+        const uint8_t slot = _index[key];
+        _index[key]        = 0;
+        std::atomic_signal_fence(std::memory_order_release);
+        _values[slot] = V();
+        _used[slot]   = false;
+        _size--;
+        return true;
+    }
+
+    /**
+     * @brief Calls func(key, value) for every stored entry (task context).
+     */
+    template <typename F> void for_each(F func) const
+    {
+        for (size_t slot = 1; slot <= Capacity; slot++)
+        {
+            if (_used[slot])
+            {
+                func(static_cast<size_t>(_keys[slot]), _values[slot]);
+            }
+        }
+    }
+
+    size_t size() const
+    {
+        return _size;
+    }
+
+    bool full() const
+    {
+        return _size >= Capacity;
+    }
+
+    void clear()
+    {
+        for (auto &slot : _index)
+        {
+            slot = 0;
+        }
+        _values.fill(V());
+        _keys.fill(0);
+        _used.fill(false);
+        _size = 0;
+    }
+
+  private:
+    size_t _size = 0;
+    std::array<volatile uint8_t, KeyRange> _index; // key -> slot, 0 = empty
+    std::array<V, Capacity + 1> _values;           // slot 0 always holds V()
+    std::array<uint16_t, Capacity + 1> _keys;
+    std::array<bool, Capacity + 1> _used;
+};
+}; // namespace pyro
+
+#endif
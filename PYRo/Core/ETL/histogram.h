@@ -0,0 +1,101 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+#include <array>
+#include <cstddef>
+#include <cstdint>
+namespace pyro
+{
+/**
+ * @brief Fixed-size log2 histogram for latencies and durations.
+ *
+ * Bucket 0 counts value 0, bucket k (k >= 1) counts values in
+ * [2^(k-1), 2^k); the last bucket also takes everything above. record() is
+ * a handful of instructions and never allocates, so it can run in an ISR.
+ * Counters from concurrent writers are not atomic: a rare lost count is
+ * accepted in exchange for no locking.
+ *
+ * @tparam Buckets Number of buckets, 16 covers values up to 16384.
+ */
+template <size_t Buckets> class histogram_t
+{
+    static_assert(Buckets >= 2 && Buckets <= 33, "1..32 bit buckets");
+
+  public:
+    constexpr static size_t _bucket_num = Buckets;
+
+    histogram_t()
+    {
+        reset();
+    }
+
+    void record(const uint32_t value)
+    {
+        size_t bucket = value ? 32U - __builtin_clz(value) : 0U;
+        if (bucket >= Buckets)
+            bucket = Buckets - 1;
+        _count[bucket]++;
+        _total++;
+        _sum += value;
+        if (value > _max)
+            _max = value;
+        if (value < _min)
+            _min = value;
+    }
+
+    void reset()
+    {
+        for (auto &count : _count)
+        {
+            count = 0;
+        }
+        _total = 0;
+        _sum   = 0;
+        _max   = 0;
+        _min   = UINT32_MAX;
+    }
+
+    uint32_t count(const size_t bucket) const
+    {
+        return bucket < Buckets ? _count[bucket] : 0;
+    }
+
+    /**
+     * @brief Exclusive upper bound of a bucket, UINT32_MAX for the last one.
+     */
+    static uint32_t upper_bound(const size_t bucket)
+    {
+        if (bucket + 1 >= Buckets || bucket >= 32)
+            return UINT32_MAX;
+        return 1UL << bucket;
+    }
+
+    uint32_t total() const
+    {
+        return _total;
+    }
+
+    uint32_t max() const
+    {
+        return _max;
+    }
+
+    uint32_t min() const
+    {
+        return _total ? _min : 0;
+    }
+
+    float mean() const
+    {
+        return _total ? static_cast<float>(_sum) / _total : 0.0f;
+    }
+
+  private:
+    std::array<volatile uint32_t, Buckets> _count;
+    volatile uint32_t _total;
+    volatile uint64_t _sum;
+    volatile uint32_t _max;
+    volatile uint32_t _min;
+};
+}; // namespace pyro
+
+#endif
@@ -6,6 +6,8 @@ extern "C"
 {
     extern void pyro_vofa_task(void *arg);
     extern void pyro_jcom_task(void *arg);
+    extern void pyro_profile_task(void *arg);
+    extern void pyro_rtos_stat_task(void *arg);
     void start_debug_task(void *arg)
     {
 #if VOFA_DEBUG_EN
@@ -17,6 +19,16 @@ extern "C"
         xTaskCreate(pyro_jcom_task, "pyro_jcom_task", 128, nullptr,
                     tskIDLE_PRIORITY + 1, nullptr);
 #endif
+
+#if PROFILE_DEBUG_EN
+        xTaskCreate(pyro_profile_task, "pyro_profile", 256, nullptr,
+                    tskIDLE_PRIORITY + 1, nullptr);
+#endif
+
+#if RTOS_STAT_DEBUG_EN
+        xTaskCreate(pyro_rtos_stat_task, "pyro_rtos_stat", 256, nullptr,
+                    tskIDLE_PRIORITY + 1, nullptr);
+#endif
         vTaskDelete(nullptr);
     }
 }
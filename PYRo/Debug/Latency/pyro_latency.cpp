@@ -0,0 +1,172 @@
+#include "pyro_latency.h"
+
+#include "main.h" // For DWT registers
+
+namespace pyro
+{
+/**
+ * @brief Takes the first free registry slot with a CAS, so paths may be
+ * constructed before the scheduler starts. Untraced past MAX_PATH_NUM.
+ */
+latency_path_t::latency_path_t(const char *name) : _name(name)
+{
+    for (auto &path : _paths)
+    {
+        latency_path_t *expected = nullptr;
+        if (path.compare_exchange_strong(expected, this))
+        {
+            break;
+        }
+    }
+}
+
+latency_path_t::~latency_path_t()
+{
+    for (auto &path : _paths)
+    {
+        latency_path_t *expected = this;
+        path.compare_exchange_strong(expected, nullptr);
+    }
+}
+
+void latency_path_t::stamp_send(const uint32_t isr_cnt) // ISR
+{
+    const uint32_t send_cnt = DWT->CYCCNT;
+    const uint8_t head      = _head;
+    const uint8_t next      = (head + 1) % STAMP_DEPTH;
+    if (next == _tail)
+    {
+        _lost = _lost + 1;
+        return;
+    }
+    _ring[head].isr  = isr_cnt;
+    _ring[head].send = send_cnt;
+    std::atomic_signal_fence(std::memory_order_release);
+    _head = next;
+}
+
+uint8_t latency_path_t::stamp_wake(const uint8_t max_num)
+{
+    const uint32_t wake_cnt = DWT->CYCCNT;
+    uint8_t tail            = _tail;
+    std::atomic_signal_fence(std::memory_order_acquire);
+    for (uint8_t i = 0; i < max_num && tail != _head &&
+                        _woken_num < STAMP_DEPTH;
+         i++)
+    {
+        stamp_t &stamp = _woken[_woken_num++];
+        stamp          = _ring[tail];
+        stamp.wake     = wake_cnt;
+        tail           = (tail + 1) % STAMP_DEPTH;
+    }
+    std::atomic_signal_fence(std::memory_order_release);
+    _tail = tail;
+    return _woken_num;
+}
+
+void latency_path_t::stamp_discard()
+{
+    _woken_num = 0;
+}
+
+void latency_path_t::stamp_done()
+{
+    const uint32_t done_cnt = DWT->CYCCNT;
+    for (uint8_t i = 0; i < _woken_num; i++)
+    {
+        record(_woken[i].isr, _woken[i].send, _woken[i].wake, done_cnt);
+    }
+    _woken_num = 0;
+}
+
+void latency_path_t::record(const uint32_t isr_cnt, const uint32_t send_cnt,
+                            const uint32_t wake_cnt, const uint32_t done_cnt)
+{
+    uint32_t stage[STAGE_NUM];
+    stage[ISR_TO_SEND]  = send_cnt - isr_cnt;
+    stage[SEND_TO_WAKE] = wake_cnt - send_cnt;
+    stage[WAKE_TO_DONE] = done_cnt - wake_cnt;
+    stage[END_TO_END]   = done_cnt - isr_cnt;
+    for (uint8_t i = 0; i < STAGE_NUM; i++)
+    {
+        _hist[i].record(stage[i]);
+    }
+
+    if (stage[END_TO_END] < _worst.stage[END_TO_END])
+    {
+        return;
+    }
+
+    // Several consumers may record on one path (e.g. can_msg_buffer_t::read()
+    // from different tasks), so the compare and the copy are done under a
+    // critical section to keep _worst from mixing two items.
+    const bool in_isr = 0 != __get_IPSR();
+    worst_t worst;
+    for (uint8_t i = 0; i < STAGE_NUM; i++)
+    {
+        worst.stage[i] = stage[i];
+    }
+    worst.task     = in_isr ? "ISR" : pcTaskGetName(nullptr);
+    worst.priority = in_isr ? 0 : uxTaskPriorityGet(nullptr);
+    worst.tick     = in_isr ? xTaskGetTickCountFromISR() : xTaskGetTickCount();
+
+    if (in_isr)
+    {
+        const UBaseType_t saved = taskENTER_CRITICAL_FROM_ISR();
+        if (stage[END_TO_END] >= _worst.stage[END_TO_END])
+        {
+            _worst = worst;
+        }
+        taskEXIT_CRITICAL_FROM_ISR(saved);
+    }
+    else
+    {
+        taskENTER_CRITICAL();
+        if (stage[END_TO_END] >= _worst.stage[END_TO_END])
+        {
+            _worst = worst;
+        }
+        taskEXIT_CRITICAL();
+    }
+}
+
+const char *latency_path_t::get_name() const
+{
+    return _name;
+}
+
+const latency_path_t::hist_t &
+latency_path_t::get_hist(const stage_t stage) const
+{
+    return _hist[stage < STAGE_NUM ? stage : END_TO_END];
+}
+
+void latency_path_t::get_worst(worst_t &worst) const
+{
+    taskENTER_CRITICAL();
+    worst = _worst;
+    taskEXIT_CRITICAL();
+}
+
+uint32_t latency_path_t::get_lost() const
+{
+    return _lost;
+}
+
+void latency_path_t::reset()
+{
+    for (auto &hist : _hist)
+    {
+        hist.reset();
+    }
+    taskENTER_CRITICAL();
+    _worst = worst_t{};
+    taskEXIT_CRITICAL();
+    _lost = 0;
+}
+
+latency_path_t *latency_path_t::get_path(const uint8_t idx)
+{
+    return idx < MAX_PATH_NUM ? _paths[idx].load() : nullptr;
+}
+} // namespace pyro
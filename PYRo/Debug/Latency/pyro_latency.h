@@ -0,0 +1,128 @@
+/**
+ * @file pyro_latency.h
+ * @brief Interrupt-to-task latency tracing for deferred-processing paths.
+ *
+ * A path is one producer ISR feeding one consumer task, e.g. UART RX event
+ * -> message buffer -> RC task -> command callbacks. Four DWT stamps are
+ * taken per item:
+ *
+ *   isr   RX event entry in the ISR
+ *   send  item handed to the buffer/queue (still in the ISR)
+ *   wake  consumer task picked the item up
+ *   done  consumer finished with it (callbacks returned)
+ *
+ * The ISR pushes {isr, send} into a small SPSC ring in step with the items
+ * it queues; the task pops them on wake() and closes them on done(). Each
+ * stage and the end-to-end time feed a log2 cycle histogram, and the worst
+ * end-to-end item is kept with the consumer task's name and priority.
+ *
+ * @version 1.0.0
+ * @date 2026-10-17
+ */
+
+#ifndef __PYRO_LATENCY_H__
+#define __PYRO_LATENCY_H__
+
+#include "FreeRTOS.h"
+#include "histogram.h"
+#include "task.h"
+
+#include <atomic>
+#include <cstdint>
+
+namespace pyro
+{
+class latency_path_t
+{
+  public:
+    static constexpr uint8_t STAMP_DEPTH  = 8; // Items in flight per path
+    static constexpr uint8_t MAX_PATH_NUM = 8;
+    using hist_t = histogram_t<24>; // Cycles, up to 2^23 (17 ms at 480 MHz)
+
+    enum stage_t : uint8_t
+    {
+        ISR_TO_SEND = 0,
+        SEND_TO_WAKE,
+        WAKE_TO_DONE,
+        END_TO_END,
+        STAGE_NUM
+    };
+
+    /**
+     * @brief Stamps of the slowest item seen since the last reset().
+     */
+    typedef struct worst_t
+    {
+        uint32_t stage[STAGE_NUM]; // Cycles per stage
+        const char *task;          // Consumer, "ISR" if closed in an ISR
+        UBaseType_t priority;
+        TickType_t tick;           // When it was closed
+    } worst_t;
+
+    explicit latency_path_t(const char *name);
+    ~latency_path_t();
+
+    /**
+     * @brief ISR side, call right after the item was queued.
+     * @param isr_cnt CYCCNT at ISR entry.
+     */
+    void stamp_send(uint32_t isr_cnt);
+
+    /**
+     * @brief Task side, marks up to max_num queued items as picked up.
+     * @return Number of items now waiting for done().
+     */
+    uint8_t stamp_wake(uint8_t max_num = 1);
+
+    /**
+     * @brief Task side, closes every item picked up by stamp_wake().
+     */
+    void stamp_done();
+
+    /**
+     * @brief Task side, forgets items picked up but not processed.
+     */
+    void stamp_discard();
+
+    /**
+     * @brief Records one item whose four stamps are already known.
+     * @note Callable from several tasks and ISRs on the same path. The
+     * histograms may lose a rare count, _worst is kept consistent.
+     */
+    void record(uint32_t isr_cnt, uint32_t send_cnt, uint32_t wake_cnt,
+                uint32_t done_cnt);
+
+    const char *get_name() const;
+    const hist_t &get_hist(stage_t stage) const;
+    void get_worst(worst_t &worst) const; // Task context
+    uint32_t get_lost() const;
+    void reset();
+
+    /**
+     * @brief Registered paths, for debug streaming. nullptr past the end.
+     */
+    static latency_path_t *get_path(uint8_t idx);
+
+  private:
+    typedef struct stamp_t
+    {
+        uint32_t isr;
+        uint32_t send;
+        uint32_t wake;
+    } stamp_t;
+
+    const char *_name;
+    stamp_t _ring[STAMP_DEPTH]{};
+    volatile uint8_t _head{}; // Written by the ISR
+    volatile uint8_t _tail{}; // Written by the task
+    stamp_t _woken[STAMP_DEPTH]{};
+    uint8_t _woken_num{};
+    volatile uint32_t _lost{}; // Ring full, item not traced
+    hist_t _hist[STAGE_NUM];
+    worst_t _worst{};
+
+    inline static std::atomic<latency_path_t *> _paths[MAX_PATH_NUM]{};
+};
+} // namespace pyro
+
+#endif
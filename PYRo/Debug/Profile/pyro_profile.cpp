@@ -0,0 +1,103 @@
+#include "pyro_profile.h"
+
+#include "pyro_uart_drv.h"
+#include "task.h"
+
+#include <cstdio>
+
+namespace pyro
+{
+uint8_t profiler_t::register_site(const char *name)
+{
+    uint8_t site = _site_num.load(std::memory_order_relaxed);
+    do
+    {
+        if (site >= MAX_SITE_NUM)
+        {
+            return MAX_SITE_NUM;
+        }
+    } while (!_site_num.compare_exchange_weak(site, site + 1,
+                                              std::memory_order_relaxed));
+    _sites[site].name = name;
+    return site;
+}
+
+uint8_t profiler_t::site_num()
+{
+    return _site_num.load(std::memory_order_relaxed);
+}
+
+bool profiler_t::snapshot(const uint8_t site, entry_t &entry, const bool reset)
+{
+    if (site >= site_num() || nullptr == _sites[site].name)
+    {
+        return false;
+    }
+    taskENTER_CRITICAL();
+    entry = _sites[site];
+    if (reset)
+    {
+        _sites[site].hist.reset();
+    }
+    taskEXIT_CRITICAL();
+    return true;
+}
+
+void profiler_t::reset()
+{
+    const uint8_t num = site_num();
+    for (uint8_t site = 0; site < num; site++)
+    {
+        taskENTER_CRITICAL();
+        _sites[site].hist.reset();
+        taskEXIT_CRITICAL();
+    }
+}
+} // namespace pyro
+
+extern "C" uint8_t pyro_profile_register(const char *name)
+{
+    return pyro::profiler_t::register_site(name);
+}
+
+extern "C" void pyro_profile_record(const uint8_t site, const uint32_t cycles)
+{
+    pyro::profiler_t::record(site, cycles);
+}
+
+/**
+ * @brief Streams the table once per second as VOFA FireWater text lines,
+ * "name:count,min,mean,max\n" in cycles, and starts a new window.
+ */
+extern "C" void pyro_profile_task(void *arg)
+{
+    pyro::uart_drv_t *uart =
+        pyro::uart_drv_t::get_instance(pyro::uart_drv_t::uart1);
+    pyro::profiler_t::entry_t entry;
+    char line[64];
+
+    while (true)
+    {
+        vTaskDelay(1000);
+        for (uint8_t site = 0; site < pyro::profiler_t::site_num(); site++)
+        {
+            if (!pyro::profiler_t::snapshot(site, entry, true))
+            {
+                continue;
+            }
+            const int len = snprintf(
+                line, sizeof(line), "%s:%lu,%lu,%lu,%lu\n", entry.name,
+                static_cast<unsigned long>(entry.hist.total()),
+                static_cast<unsigned long>(entry.hist.min()),
+                static_cast<unsigned long>(entry.hist.mean() + 0.5f),
+                static_cast<unsigned long>(entry.hist.max()));
+            if (len > 0)
+            {
+                const auto size = static_cast<uint16_t>(
+                    len < static_cast<int>(sizeof(line)) ? len
+                                                         : sizeof(line) - 1);
+                uart->write(reinterpret_cast<const uint8_t *>(line), size);
+            }
+        }
+    }
+}
@@ -0,0 +1,164 @@
+/**
+ * @file pyro_profile.h
+ * @brief Scoped cycle profiler built on the DWT CYCCNT register.
+ *
+ * PYRO_PROFILE_SCOPE("name") at the top of a block records the cycles spent
+ * in that block into a static per-call-site table (count, min, max, mean and
+ * a log2 histogram). C code uses the PYRO_PROFILE_BEGIN / PYRO_PROFILE_END
+ * pair. With PROFILE_DEBUG_EN = 0 every macro expands to nothing.
+ *
+ * @version 1.0.0
+ * @date 2026-10-17
+ */
+
+#ifndef __PYRO_PROFILE_H__
+#define __PYRO_PROFILE_H__
+
+#include "main.h" // For DWT registers
+#include "pyro_core_config.h"
+
+#include <stdint.h>
+
+#define PYRO_PROFILE_MAX_SITE_NUM 32U
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * @brief Claims a table slot for a call site, returns
+ * PYRO_PROFILE_MAX_SITE_NUM once the table is full. Safe from any context.
+ */
+uint8_t pyro_profile_register(const char *name);
+void pyro_profile_record(uint8_t site, uint32_t cycles);
+void pyro_profile_task(void *arg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#if PROFILE_DEBUG_EN
+
+#define PYRO_PROFILE_BEGIN(tag, name)                                          \
+    static uint8_t tag##_site = 0xFFU;                                         \
+    if (0xFFU == tag##_site)                                                   \
+        tag##_site = pyro_profile_register(name);                              \
+    const uint32_t tag##_start = DWT->CYCCNT
+
+#define PYRO_PROFILE_END(tag)                                                  \
+    pyro_profile_record(tag##_site, DWT->CYCCNT - tag##_start)
+
+#else
+
+#define PYRO_PROFILE_BEGIN(tag, name) ((void)0)
+#define PYRO_PROFILE_END(tag) ((void)0)
+
+#endif
+
+#ifdef __cplusplus
+
+#include "histogram.h"
+
+#include <atomic>
+
+namespace pyro
+{
+/**
+ * @brief Static table of profiled call sites.
+ *
+ * Slots are claimed lock-free on the first pass through a site and never
+ * released. Records from concurrent contexts into the same site follow the
+ * histogram_t rule: a rare lost count instead of a lock.
+ */
+class profiler_t
+{
+  public:
+    static constexpr uint8_t MAX_SITE_NUM = PYRO_PROFILE_MAX_SITE_NUM;
+    using hist_t = histogram_t<24>; // Up to 2^23 cycles (17 ms at 480 MHz)
+
+    typedef struct entry_t
+    {
+        const char *name;
+        hist_t hist; // In cycles
+    } entry_t;
+
+    profiler_t() = delete;
+
+    static uint8_t register_site(const char *name);
+
+    static void record(const uint8_t site, const uint32_t cycles)
+    {
+        if (site < MAX_SITE_NUM)
+        {
+            _sites[site].hist.record(cycles);
+        }
+    }
+
+    /**
+     * @brief Number of sites registered so far.
+     */
+    static uint8_t site_num();
+
+    /**
+     * @brief Copies one site with interrupts masked, optionally clearing it.
+     * @return false if the slot is not in use.
+     */
+    static bool snapshot(uint8_t site, entry_t &entry, bool reset = false);
+
+    /**
+     * @brief Clears the statistics of every site, keeping the registrations.
+     */
+    static void reset();
+
+  private:
+    inline static entry_t _sites[MAX_SITE_NUM]{};
+    inline static std::atomic<uint8_t> _site_num{};
+};
+
+/**
+ * @brief Stamps CYCCNT on construction and records the delta on exit.
+ */
+class profile_scope_t
+{
+  public:
+    explicit profile_scope_t(const uint8_t site)
+        : _site(site), _start(DWT->CYCCNT)
+    {
+    }
+
+    ~profile_scope_t()
+    {
+        profiler_t::record(_site, DWT->CYCCNT - _start);
+    }
+
+    profile_scope_t(const profile_scope_t &)            = delete;
+    profile_scope_t &operator=(const profile_scope_t &) = delete;
+
+  private:
+    const uint8_t _site;
+    const uint32_t _start;
+};
+} // namespace pyro
+
+#define PYRO_PROFILE_CAT_(a, b) a##b
+#define PYRO_PROFILE_CAT(a, b) PYRO_PROFILE_CAT_(a, b)
+
+#if PROFILE_DEBUG_EN
+
+#define PYRO_PROFILE_SCOPE(name)                                               \
+    static const uint8_t PYRO_PROFILE_CAT(_pyro_profile_site_, __LINE__) =     \
+        ::pyro::profiler_t::register_site(name);                               \
+    const ::pyro::profile_scope_t PYRO_PROFILE_CAT(_pyro_profile_scope_,       \
+                                                   __LINE__)(                  \
+        PYRO_PROFILE_CAT(_pyro_profile_site_, __LINE__))
+
+#else
+
+#define PYRO_PROFILE_SCOPE(name) ((void)0)
+
+#endif
+
+#endif // __cplusplus
+
+#endif // __PYRO_PROFILE_H__
@@ -0,0 +1,202 @@
+#include "pyro_rtos_stat.h"
+
+#include "main.h" // For DWT registers
+#include "pyro_uart_drv.h"
+
+#include <cstdio>
+
+namespace pyro
+{
+void rtos_stat_t::task_create(TaskHandle_t handle, const uint32_t task_num)
+{
+    if (task_num >= MAX_TASK_NUM)
+    {
+        return;
+    }
+    slot_t &slot   = _slots[task_num];
+    slot.run       = 0;
+    slot.burst     = 0;
+    slot.burst_max = 0;
+    slot.handle    = handle;
+}
+
+void rtos_stat_t::task_delete(const uint32_t task_num)
+{
+    if (task_num < MAX_TASK_NUM)
+    {
+        _slots[task_num].handle = nullptr;
+    }
+}
+
+void rtos_stat_t::switched_in(const uint32_t task_num)
+{
+    if (task_num < MAX_TASK_NUM)
+    {
+        _slots[task_num].in_at = DWT->CYCCNT;
+    }
+}
+
+void rtos_stat_t::switched_out(const uint32_t task_num, const bool ready)
+{
+    if (task_num >= MAX_TASK_NUM)
+    {
+        return;
+    }
+    slot_t &slot         = _slots[task_num];
+    const uint32_t slice = DWT->CYCCNT - slot.in_at;
+    slot.run             = slot.run + slice;
+    slot.burst += slice;
+    if (slot.burst > slot.burst_max)
+    {
+        slot.burst_max = slot.burst;
+    }
+    if (!ready)
+    {
+        slot.burst = 0; // Blocked, the next switch-in starts a new burst
+    }
+}
+
+/**
+ * @brief Stores this window's run deltas. Deltas stay below 2^32 cycles as
+ * long as sample() runs more often than once per CYCCNT period.
+ */
+void rtos_stat_t::sample()
+{
+    const uint32_t cyc_now = DWT->CYCCNT;
+    _window_idx            = (_window_idx + 1) % WINDOW_NUM;
+    _cyc_delta[_window_idx] = cyc_now - _cyc_last;
+    _cyc_last               = cyc_now;
+
+    for (uint8_t i = 0; i < MAX_TASK_NUM; i++)
+    {
+        const TaskHandle_t handle = _slots[i].handle;
+        const uint32_t run        = _slots[i].run;
+        window_t &window          = _windows[i];
+        if (handle != window.handle)
+        {
+            // New task in this slot, start its history from here
+            window          = window_t{};
+            window.handle   = handle;
+            window.run_last = run;
+        }
+        window.run_delta[_window_idx] = run - window.run_last;
+        window.run_last               = run;
+    }
+}
+
+/**
+ * @brief The stack scan walks the task's stack without locking the
+ * scheduler, so control tasks are not held off. The tasks of this firmware
+ * only delete themselves, which frees the TCB from the idle task, never
+ * while a higher-priority reporter is running.
+ */
+bool rtos_stat_t::get_task_stat(const uint8_t slot, task_stat_t &stat)
+{
+    if (slot >= MAX_TASK_NUM)
+    {
+        return false;
+    }
+    const window_t &window = _windows[slot];
+    if (nullptr == window.handle || window.handle != _slots[slot].handle)
+    {
+        return false;
+    }
+
+    uint64_t run_sum = 0;
+    uint64_t cyc_sum = 0;
+    for (uint8_t i = 0; i < WINDOW_NUM; i++)
+    {
+        run_sum += window.run_delta[i];
+        cyc_sum += _cyc_delta[i];
+    }
+    const uint32_t cyc_last = _cyc_delta[_window_idx];
+
+    stat.name     = pcTaskGetName(window.handle);
+    stat.cpu_last = cyc_last ? 100.0f *
+                                   static_cast<float>(
+                                       window.run_delta[_window_idx]) /
+                                   static_cast<float>(cyc_last)
+                             : 0.0f;
+    stat.cpu_avg  = cyc_sum ? 100.0f * static_cast<float>(run_sum) /
+                                 static_cast<float>(cyc_sum)
+                            : 0.0f;
+    stat.stack_free = uxTaskGetStackHighWaterMark(window.handle);
+    stat.burst_max  = _slots[slot].burst_max;
+    return true;
+}
+
+void rtos_stat_t::reset_burst_max()
+{
+    taskENTER_CRITICAL();
+    for (auto &slot : _slots)
+    {
+        slot.burst_max = 0;
+    }
+    taskEXIT_CRITICAL();
+}
+} // namespace pyro
+
+extern "C" void pyro_rtos_stat_task_create(void *handle,
+                                           const uint32_t task_num)
+{
+    pyro::rtos_stat_t::task_create(static_cast<TaskHandle_t>(handle),
+                                   task_num);
+}
+
+extern "C" void pyro_rtos_stat_task_delete(const uint32_t task_num)
+{
+    pyro::rtos_stat_t::task_delete(task_num);
+}
+
+extern "C" void pyro_rtos_stat_switched_in(const uint32_t task_num)
+{
+    pyro::rtos_stat_t::switched_in(task_num);
+}
+
+extern "C" void pyro_rtos_stat_switched_out(const uint32_t task_num,
+                                            const uint32_t ready)
+{
+    pyro::rtos_stat_t::switched_out(task_num, 0 != ready);
+}
+
+/**
+ * @brief Closes a window every second and streams one VOFA FireWater line
+ * per task, "name:cpu_last,cpu_avg,stack_free,burst_max_us\n" (CPU in 0.1 %).
+ * Lines go through the UART TX queue, so the reporter never waits on the
+ * wire and runs just above idle.
+ */
+extern "C" void pyro_rtos_stat_task(void *arg)
+{
+    pyro::uart_drv_t *uart =
+        pyro::uart_drv_t::get_instance(pyro::uart_drv_t::uart1);
+    pyro::rtos_stat_t::task_stat_t stat;
+    char line[64];
+
+    pyro::rtos_stat_t::sample();
+    while (true)
+    {
+        vTaskDelay(1000);
+        pyro::rtos_stat_t::sample();
+        const uint32_t cyc_per_us = SystemCoreClock / 1000000U;
+        for (uint8_t slot = 0; slot < pyro::rtos_stat_t::MAX_TASK_NUM; slot++)
+        {
+            if (!pyro::rtos_stat_t::get_task_stat(slot, stat))
+            {
+                continue;
+            }
+            const int len = snprintf(
+                line, sizeof(line), "%s:%lu,%lu,%lu,%lu\n", stat.name,
+                static_cast<unsigned long>(stat.cpu_last * 10.0f + 0.5f),
+                static_cast<unsigned long>(stat.cpu_avg * 10.0f + 0.5f),
+                static_cast<unsigned long>(stat.stack_free),
+                static_cast<unsigned long>(stat.burst_max / cyc_per_us));
+            if (len > 0)
+            {
+                const auto size = static_cast<uint16_t>(
+                    len < static_cast<int>(sizeof(line)) ? len
+                                                         : sizeof(line) - 1);
+                uart->write(reinterpret_cast<const uint8_t *>(line), size);
+            }
+        }
+    }
+}
@@ -0,0 +1,94 @@
+/**
+ * @file pyro_rtos_stat.h
+ * @brief Per-task CPU load, stack and burst statistics on the DWT counter.
+ *
+ * FreeRTOS calls the trace hooks declared in FreeRTOSConfig.h on every
+ * task creation, deletion and context switch. They accumulate, per task,
+ * the cycles spent running and the longest burst run before blocking
+ * (preemptions do not end a burst). Interrupt time lands on the task that
+ * was interrupted. A low-priority reporter closes one-second windows with
+ * sample() and derives CPU load over the last window and over the last
+ * WINDOW_NUM windows.
+ *
+ * The hooks are only defined with RTOS_STAT_DEBUG_EN. Otherwise the kernel
+ * never calls in and every slot stays empty.
+ *
+ * @version 1.0.0
+ * @date 2026-10-17
+ */
+
+#ifndef __PYRO_RTOS_STAT_H__
+#define __PYRO_RTOS_STAT_H__
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include <cstdint>
+
+namespace pyro
+{
+class rtos_stat_t
+{
+  public:
+    static constexpr uint8_t MAX_TASK_NUM = 24; // By FreeRTOS task number
+    static constexpr uint8_t WINDOW_NUM   = 10; // Windows in the long average
+
+    typedef struct task_stat_t
+    {
+        const char *name;
+        float cpu_last;       // % of the last window
+        float cpu_avg;        // % over the last WINDOW_NUM windows
+        uint32_t stack_free;  // High-water mark, words never used
+        uint32_t burst_max;   // Longest run before blocking, cycles
+    } task_stat_t;
+
+    rtos_stat_t() = delete;
+
+    // --- Kernel hooks, called with the scheduler locked ---
+    static void task_create(TaskHandle_t handle, uint32_t task_num);
+    static void task_delete(uint32_t task_num);
+    static void switched_in(uint32_t task_num);
+    static void switched_out(uint32_t task_num, bool ready);
+
+    /**
+     * @brief Closes the current window. Call periodically from one task.
+     */
+    static void sample();
+
+    /**
+     * @brief Reads one slot as of the last sample().
+     * @return false if no task occupies the slot.
+     */
+    static bool get_task_stat(uint8_t slot, task_stat_t &stat);
+
+    /**
+     * @brief Clears the per-task burst maxima.
+     */
+    static void reset_burst_max();
+
+  private:
+    typedef struct slot_t
+    {
+        TaskHandle_t volatile handle;
+        volatile uint32_t run;       // Cycles, wraps, read as deltas
+        uint32_t in_at;              // CYCCNT at switch-in
+        uint32_t burst;              // Cycles since the task last unblocked
+        volatile uint32_t burst_max;
+    } slot_t;
+
+    typedef struct window_t
+    {
+        TaskHandle_t handle; // Owner of the deltas below
+        uint32_t run_last;
+        uint32_t run_delta[WINDOW_NUM];
+    } window_t;
+
+    inline static slot_t _slots[MAX_TASK_NUM]{};
+    inline static window_t _windows[MAX_TASK_NUM]{};
+    inline static uint32_t _cyc_last{};
+    inline static uint32_t _cyc_delta[WINDOW_NUM]{};
+    inline static uint8_t _window_idx{};
+};
+} // namespace pyro
+
+#endif
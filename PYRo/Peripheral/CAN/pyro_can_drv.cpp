@@ -1,6 +1,9 @@
 #include "pyro_can_drv.h"
 #include "main.h"
+#include "pyro_dwt_drv.h"
+#include "pyro_profile.h"
 
+#include <atomic>
 #include <cstring>
 
 
@@ -8,15 +11,14 @@
 namespace pyro
 {
 can_msg_buffer_t::can_msg_buffer_t(uint32_t id)
-    : _id(id), _is_fresh(false), _last_update_time(0)
+    : _id(id), _seq(0), _timestamp(0), _write_cnt(0), _last_update_time(0),
+      _read_generation(0)
 {
     _buffer.fill(0);
-    //_mtx = xSemaphoreCreateMutex();
 }
 
 can_msg_buffer_t::~can_msg_buffer_t(void)
 {
-    // vSemaphoreDelete(_mtx);
 }
 
 uint32_t can_msg_buffer_t::get_id(void)
@@ -24,40 +26,141 @@ uint32_t can_msg_buffer_t::get_id(void)
     return _id;
 }
 
+uint32_t can_msg_buffer_t::get_generation(void)
+{
+    return _seq >> 1;
+}
+
 bool can_msg_buffer_t::is_fresh(void)
 {
-    return _is_fresh;
+    return get_generation() != _read_generation;
 }
 
 void can_msg_buffer_t::mark_read(void)
 {
-    // if(xSemaphoreTake(_mtx,portMAX_DELAY)==pdTRUE){
-    _is_fresh = false;
-    // xSemaphoreGive(_mtx);
-    //}
+    _read_generation = get_generation();
 }
 
-void can_msg_buffer_t::update_data(const uint8_t *data) // Mutex or not
+void can_msg_buffer_t::update_data(const uint8_t *data)
 {
-    // if(xSemaphoreTake(_mtx,portMAX_DELAY)==pdTRUE){
+    update_data(data, dwt_drv_t::get_current_ticks());
+}
+
+/**
+ * @param timestamp DWT CYCCNT of the frame's arrival. ISR, single writer.
+ */
+void can_msg_buffer_t::update_data(const uint8_t *data, uint32_t timestamp)
+{
+    _seq = _seq + 1;
+    std::atomic_signal_fence(std::memory_order_seq_cst);
     memcpy(_buffer.data(), data, 8);
-    _last_update_time = xTaskGetTickCount();
-    _is_fresh         = true;
-    // xSemaphoreGive(_mtx);
-    // }
+    _timestamp        = timestamp;
+    _write_cnt        = dwt_drv_t::get_current_ticks();
+    _last_update_time = xTaskGetTickCountFromISR();
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+    _seq = _seq + 1;
+}
+
+/**
+ * @brief Seqlock read side. The writer is an ISR that always runs to
+ * completion, so the retry loop terminates.
+ * @return Generation of the copied frame.
+ */
+uint32_t can_msg_buffer_t::load(std::array<uint8_t, 8> &data,
+                                uint32_t &timestamp, TickType_t &tick,
+                                uint32_t &write_cnt)
+{
+    uint32_t seq;
+    do
+    {
+        seq = _seq;
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+        memcpy(data.data(), _buffer.data(), 8);
+        timestamp = _timestamp;
+        tick      = _last_update_time;
+        write_cnt = _write_cnt;
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+    } while ((seq & 0x01U) || seq != _seq);
+    return seq >> 1;
 }
 
 bool can_msg_buffer_t::get_data(std::array<uint8_t, 8> &data)
 {
-    // if(xSemaphoreTake(_mtx,portMAX_DELAY)==pdTRUE){
-    memcpy(data.data(), _buffer.data(), 8);
-    // xSemaphoreGive(_mtx);
+    uint32_t timestamp;
+    TickType_t tick;
+    uint32_t write_cnt;
+    return load(data, timestamp, tick, write_cnt) != 0;
+}
+
+/**
+ * @brief Copies the latest frame into the caller's snapshot.
+ * @param snapshot In: the generation this caller read last (0 at first).
+ * Out: the latest frame. Keeping it across calls is what makes the
+ * dropped count and the return value per consumer.
+ * @return true if a frame arrived since this caller's previous read().
+ */
+bool can_msg_buffer_t::read(snapshot_t &snapshot)
+{
+    TickType_t tick;
+    uint32_t write_cnt;
+    const uint32_t last_generation = snapshot.generation;
+    snapshot.generation =
+        load(snapshot.data, snapshot.timestamp, tick, write_cnt);
+
+    uint32_t cnt_last = snapshot.timestamp;
+    snapshot.age      = dwt_drv_t::get_delta_t(&cnt_last);
+
+    const uint32_t new_frames = snapshot.generation - last_generation;
+    snapshot.dropped          = new_frames > 1 ? new_frames - 1 : 0;
+    if (0 == new_frames)
+        return false;
+
+    // Once per frame and consumer: re-reads of the same frame by a loop
+    // faster than the feedback would flood the histogram with its age
+    if (nullptr != _age_hist)
+        _age_hist->record(static_cast<uint32_t>(snapshot.age * 1e6f));
+    if (nullptr != _latency)
+    {
+        const uint32_t now = cnt_last;
+        _latency->record(snapshot.timestamp, write_cnt, now, now);
+    }
     return true;
-    // }
-    // return false;
 }
 
+void can_msg_buffer_t::attach_age_hist(can_latency_hist_t *hist)
+{
+    _age_hist = hist;
+}
+
+void can_msg_buffer_t::attach_latency(latency_path_t *path)
+{
+    _latency = path;
+}
+
+TickType_t can_msg_buffer_t::get_last_update_time(void)
+{
+    uint32_t timestamp;
+    TickType_t tick;
+    uint32_t write_cnt;
+    std::array<uint8_t, 8> data;
+    load(data, timestamp, tick, write_cnt);
+    return tick;
+}
+
+// Nominal length of a classic standard data frame incl. 3 bit intermission,
+// stuff bits not counted
+static inline uint32_t std_frame_bits(uint32_t data_bytes)
+{
+    return 47U + 8U * data_bytes;
+}
 
+// FD frame in nominal bit times: ~29 bits of arbitration, ACK and EOF at
+// the nominal rate, the data phase (header, data, stuff count, CRC) at the
+// data rate
+static inline uint32_t fd_frame_bits(uint32_t data_bytes, uint32_t ratio)
+{
+    return 29U + (8U * data_bytes + 28U + ratio - 1U) / ratio;
+}
 
 can_drv_t::can_drv_t(FDCAN_HandleTypeDef *hfdcan)
 {
@@ -73,22 +176,19 @@ can_drv_t::~can_drv_t(void)
 
 pyro::status_t can_drv_t::init(void)
 {
-    FDCAN_FilterTypeDef fdcan_filter;
-    fdcan_filter.IdType       = FDCAN_STANDARD_ID;
-    fdcan_filter.FilterIndex  = 0;
-    fdcan_filter.FilterType   = FDCAN_FILTER_MASK;
-    fdcan_filter.FilterConfig = FDCAN_FILTER_TO_RXFIFO0;
-    fdcan_filter.FilterID1    = 0x00;
-    fdcan_filter.FilterID2    = 0x00;
-
-    if (HAL_OK != HAL_FDCAN_ConfigFilter(_hfdcan, &fdcan_filter))
+    const uint32_t quanta = 1U + _hfdcan->Init.NominalTimeSeg1 +
+                            _hfdcan->Init.NominalTimeSeg2;
+    _bit_rate = HAL_RCCEx_GetPeriphCLKFreq(RCC_PERIPHCLK_FDCAN) /
+                (_hfdcan->Init.NominalPrescaler * quanta);
+    _cyc_per_bit = _bit_rate ? SystemCoreClock / _bit_rate : 0;
+    _cyc_per_us  = SystemCoreClock / 1000000U;
+    _err_stat.backoff_ms = BUS_OFF_BACKOFF_MIN_MS;
+    if (pyro::PYRO_OK != config_filters())
         return pyro::PYRO_ERROR;
     if (HAL_OK !=
         HAL_FDCAN_ConfigGlobalFilter(_hfdcan, FDCAN_REJECT, FDCAN_REJECT,
                                      FDCAN_REJECT_REMOTE, FDCAN_REJECT_REMOTE))
         return pyro::PYRO_ERROR;
-    if (HAL_OK != HAL_FDCAN_ConfigFifoWatermark(_hfdcan, FDCAN_CFG_RX_FIFO0, 1))
-        return pyro::PYRO_ERROR;
     if (pyro::PYRO_OK !=
         pyro::can_hub_t::get_instance()->hub_register_can_obj(_hfdcan, this))
         return pyro::PYRO_ERROR;
@@ -98,78 +198,806 @@ pyro::status_t can_drv_t::init(void)
 
 pyro::status_t can_drv_t::start(void)
 {
+    uint32_t rx_its = FDCAN_IT_RX_FIFO0_NEW_MESSAGE;
+    if (HAL_OK != HAL_FDCAN_ConfigFifoWatermark(_hfdcan, FDCAN_CFG_RX_FIFO0,
+                                                _rx_watermark))
+        return pyro::PYRO_ERROR;
+    // 16-bit timestamp in bit times, captured by the core at SOF
+    if (HAL_OK !=
+        HAL_FDCAN_ConfigTimestampCounter(_hfdcan, FDCAN_TIMESTAMP_PRESC_1))
+        return pyro::PYRO_ERROR;
+    if (HAL_OK !=
+        HAL_FDCAN_EnableTimestampCounter(_hfdcan, FDCAN_TIMESTAMP_INTERNAL))
+        return pyro::PYRO_ERROR;
+    if (_rx_watermark > 1)
+    {
+        // Batched: IRQ at the watermark, or once the oldest pending frame
+        // has waited _rx_timeout bit times (counter preset while FIFO empty)
+        rx_its = FDCAN_IT_RX_FIFO0_WATERMARK | FDCAN_IT_TIMEOUT_OCCURRED;
+        if (HAL_OK != HAL_FDCAN_ConfigTimeoutCounter(
+                          _hfdcan, FDCAN_TIMEOUT_RX_FIFO0, _rx_timeout))
+            return pyro::PYRO_ERROR;
+        if (HAL_OK != HAL_FDCAN_EnableTimeoutCounter(_hfdcan))
+            return pyro::PYRO_ERROR;
+    }
     if (HAL_OK != HAL_FDCAN_Start(_hfdcan))
         return pyro::PYRO_ERROR;
+    if (HAL_OK != HAL_FDCAN_ActivateNotification(_hfdcan, rx_its, 0))
+        return pyro::PYRO_ERROR;
+    if (_hfdcan->Init.RxFifo1ElmtsNbr > 0)
+    {
+        // Low-priority class: FIFO1 on interrupt line 1 (FDCANx_IT1)
+        if (HAL_OK != HAL_FDCAN_ConfigInterruptLines(
+                          _hfdcan, FDCAN_IT_RX_FIFO1_NEW_MESSAGE,
+                          FDCAN_INTERRUPT_LINE1))
+            return pyro::PYRO_ERROR;
+        if (HAL_OK != HAL_FDCAN_ActivateNotification(
+                          _hfdcan, FDCAN_IT_RX_FIFO1_NEW_MESSAGE, 0))
+            return pyro::PYRO_ERROR;
+    }
+    // TX FIFO elements follow the dedicated TX buffers in TXBTIE
+    const uint32_t tx_elmts = _hfdcan->Init.TxFifoQueueElmtsNbr +
+                              _hfdcan->Init.TxBuffersNbr;
+    const uint32_t tx_fifo_mask =
+        (tx_elmts >= 32U ? 0xFFFFFFFFU : ((1UL << tx_elmts) - 1U)) &
+        ~((1UL << _hfdcan->Init.TxBuffersNbr) - 1U);
+    if (HAL_OK != HAL_FDCAN_ActivateNotification(
+                      _hfdcan, FDCAN_IT_TX_COMPLETE, tx_fifo_mask))
+        return pyro::PYRO_ERROR;
     if (HAL_OK != HAL_FDCAN_ActivateNotification(
-                      _hfdcan, FDCAN_IT_RX_FIFO0_NEW_MESSAGE, 0))
+                      _hfdcan,
+                      FDCAN_IT_ERROR_PASSIVE | FDCAN_IT_ERROR_WARNING |
+                          FDCAN_IT_BUS_OFF,
+                      0))
         return pyro::PYRO_ERROR;
+    _stat_cnt_last = dwt_drv_t::get_current_ticks();
+    return pyro::PYRO_OK;
+}
+
+/**
+ * @brief Selects per-frame or batched RX interrupts, call before start().
+ * @param watermark Fill level that raises the RX interrupt, 1 = every frame.
+ * @param timeout_bits Max wait of the oldest frame below the watermark, in
+ * CAN bit times (1 us at 1 Mbit/s). Required when watermark > 1.
+ */
+pyro::status_t can_drv_t::config_rx_batch(uint8_t watermark,
+                                          uint16_t timeout_bits)
+{
+    if (0 == watermark || watermark > _hfdcan->Init.RxFifo0ElmtsNbr)
+        return pyro::PYRO_PARAM_ERROR;
+    if (watermark > 1 && 0 == timeout_bits)
+        return pyro::PYRO_PARAM_ERROR;
+    if (HAL_FDCAN_STATE_READY != _hfdcan->State)
+        return pyro::PYRO_BUSY;
+    _rx_watermark = watermark;
+    _rx_timeout   = timeout_bits;
+    return pyro::PYRO_OK;
+}
+
+/**
+ * @brief Holds motor-class frames until flush_tx() so that one control
+ * tick's commands leave back-to-back. Other classes are not held.
+ */
+pyro::status_t can_drv_t::config_tx_cycle_flush(bool enable)
+{
+    UBaseType_t irq_state = taskENTER_CRITICAL_FROM_ISR();
+    _tx_cycle_flush       = enable;
+    _tx_flushing          = false;
+    taskEXIT_CRITICAL_FROM_ISR(irq_state);
+    if (!enable)
+        return flush_tx();
+    return pyro::PYRO_OK;
+}
+
+/**
+ * @brief Queues a classic 8-byte frame by priority and refills the HW FIFO.
+ *
+ * Callable from tasks and from ISRs up to the FreeRTOS syscall priority.
+ * @return PYRO_NO_MEMORY if the queue of this class is full (frame dropped).
+ */
+pyro::status_t can_drv_t::send_msg(uint32_t id, uint8_t *data,
+                                   tx_priority_t priority)
+{
+    if (nullptr == data || id >= MAX_STD_ID_NUM || priority >= TX_PRIO_NUM)
+        return pyro::PYRO_PARAM_ERROR;
+
+    if (_err_stat.bus_off_pending)
+        recover_bus_off();
+
+    tx_queue_t &queue     = _tx_queue[priority];
+    UBaseType_t irq_state = taskENTER_CRITICAL_FROM_ISR();
+    if (queue.count >= TX_QUEUE_DEPTH)
+    {
+        _tx_stat.tx_dropped[priority]++;
+        taskEXIT_CRITICAL_FROM_ISR(irq_state);
+        return pyro::PYRO_NO_MEMORY;
+    }
+    tx_frame_t &frame = queue.frames[(queue.head + queue.count) %
+                                     TX_QUEUE_DEPTH];
+    frame.id          = static_cast<uint16_t>(id);
+    frame.enqueue_cnt = dwt_drv_t::get_current_ticks();
+    memcpy(frame.data.data(), data, 8);
+    queue.count++;
+    if (queue.count > _tx_stat.high_water[priority])
+        _tx_stat.high_water[priority] = queue.count;
+    pump_tx();
+    taskEXIT_CRITICAL_FROM_ISR(irq_state);
     return pyro::PYRO_OK;
 }
 
-pyro::status_t can_drv_t::send_msg(uint32_t id, uint8_t *data)
+/**
+ * @brief Releases the held motor frames, call once per control cycle.
+ */
+pyro::status_t can_drv_t::flush_tx()
+{
+    UBaseType_t irq_state = taskENTER_CRITICAL_FROM_ISR();
+    _tx_flushing          = true;
+    pump_tx();
+    taskEXIT_CRITICAL_FROM_ISR(irq_state);
+    return pyro::PYRO_OK;
+}
+
+/**
+ * @brief Moves queued frames into free HW FIFO elements, highest class
+ * first. Caller holds the critical section.
+ */
+void can_drv_t::pump_tx()
 {
     FDCAN_TxHeaderTypeDef tx_header;
-    // if(xSemaphoreTake(_registermtx,portMAX_DELAY)==pdTRUE){
     tx_header.IdType              = FDCAN_STANDARD_ID;
-    tx_header.Identifier          = id;
     tx_header.TxFrameType         = FDCAN_DATA_FRAME;
-    tx_header.DataLength          = 8;
+    tx_header.DataLength          = FDCAN_DLC_BYTES_8;
     tx_header.ErrorStateIndicator = FDCAN_ESI_ACTIVE;
     tx_header.BitRateSwitch       = FDCAN_BRS_OFF;
     tx_header.FDFormat            = FDCAN_CLASSIC_CAN;
     tx_header.TxEventFifoControl  = FDCAN_NO_TX_EVENTS;
     tx_header.MessageMarker       = 0;
 
-    if (HAL_OK != HAL_FDCAN_AddMessageToTxFifoQ(_hfdcan, &tx_header, data))
+    uint32_t free_level = HAL_FDCAN_GetTxFifoFreeLevel(_hfdcan);
+    for (uint8_t prio = TX_PRIO_MOTOR; prio < TX_PRIO_NUM && free_level > 0;)
     {
-        // xSemaphoreGive(_registermtx);
-        return pyro::PYRO_ERROR;
+        tx_queue_t &queue = _tx_queue[prio];
+        if (0 == queue.count ||
+            (TX_PRIO_MOTOR == prio && _tx_cycle_flush && !_tx_flushing))
+        {
+            prio++;
+            continue;
+        }
+        tx_frame_t &frame    = queue.frames[queue.head];
+        tx_header.Identifier = frame.id;
+        if (HAL_OK != HAL_FDCAN_AddMessageToTxFifoQ(_hfdcan, &tx_header,
+                                                    frame.data.data()))
+            break;
+        mark_tx_inflight(frame.enqueue_cnt, std_frame_bits(8));
+        queue.head = (queue.head + 1) % TX_QUEUE_DEPTH;
+        queue.count--;
+        _tx_stat.tx_sent++;
+        free_level--;
     }
+    if (0 == _tx_queue[TX_PRIO_MOTOR].count)
+        _tx_flushing = false;
+}
 
-    // xSemaphoreGive(_registermtx);
+/**
+ * @brief Tags the HW buffer of the frame just added to the TX FIFO.
+ */
+void can_drv_t::mark_tx_inflight(uint32_t enqueue_cnt, uint16_t bits)
+{
+    const uint32_t buffer = HAL_FDCAN_GetLatestTxFifoQRequestBuffer(_hfdcan);
+    if (0 == buffer)
+        return;
+    _tx_inflight_cnt[__builtin_ctz(buffer)]  = enqueue_cnt;
+    _tx_inflight_bits[__builtin_ctz(buffer)] = bits;
+}
+
+/**
+ * @brief TX complete interrupt: frees HW FIFO elements, refill them (ISR).
+ */
+pyro::status_t can_drv_t::handle_tx_complete(uint32_t buffer_indexes)
+{
+    const uint32_t frames = __builtin_popcount(buffer_indexes);
+    const uint32_t now    = dwt_drv_t::get_current_ticks();
+    UBaseType_t irq_state = taskENTER_CRITICAL_FROM_ISR();
+    for (uint32_t mask = buffer_indexes; mask; mask &= mask - 1)
+    {
+        const uint32_t buffer = __builtin_ctz(mask);
+        _tx_latency_hist.record((now - _tx_inflight_cnt[buffer]) /
+                                _cyc_per_us);
+        _err_stat.tx_bits += _tx_inflight_bits[buffer];
+    }
+    _tx_stat.tx_complete += frames;
+    pump_tx();
+    taskEXIT_CRITICAL_FROM_ISR(irq_state);
     return pyro::PYRO_OK;
-    // }
-    // return pyro::PYRO_ERROR;
 }
 
-pyro::status_t can_drv_t::register_rx_msg(can_msg_buffer_t *msg_buffer)
+const can_drv_t::tx_stat_t &can_drv_t::get_tx_stat() const
 {
-    // if(xSemaphoreTake(_registermtx,portMAX_DELAY)==pdTRUE)
-    // {
-    uint32_t id = msg_buffer->get_id();
-    if (this->_registerlist.exist(id))
+    return _tx_stat;
+}
+
+/**
+ * @brief Error status change interrupt (EP/EW/BO), ISR.
+ *
+ * On bus-off the core sets CCCR.INIT and stops. The restart is deferred by
+ * a backoff that doubles while bus-offs follow each other within
+ * BUS_OFF_BACKOFF_MAX_MS of a restart, and is issued by recover_bus_off().
+ */
+pyro::status_t can_drv_t::handle_error_status(uint32_t error_status_its)
+{
+    FDCAN_ProtocolStatusTypeDef protocol_status;
+    if (HAL_OK != HAL_FDCAN_GetProtocolStatus(_hfdcan, &protocol_status))
+        return pyro::PYRO_ERROR;
+    if (protocol_status.LastErrorCode != FDCAN_PROTOCOL_ERROR_NONE &&
+        protocol_status.LastErrorCode != FDCAN_PROTOCOL_ERROR_NO_CHANGE)
+        _err_stat.last_error_code = protocol_status.LastErrorCode;
+
+    if ((error_status_its & FDCAN_IR_EP) && protocol_status.ErrorPassive)
+        _err_stat.error_passive_events++;
+    if ((error_status_its & FDCAN_IR_BO) && protocol_status.BusOff &&
+        !_err_stat.bus_off_pending)
+    {
+        const uint32_t now = HAL_GetTick();
+        _err_stat.bus_off_events++;
+        if (_err_stat.bus_off_recoveries > 0 &&
+            now - _err_stat.recover_tick < BUS_OFF_BACKOFF_MAX_MS)
+        {
+            const uint32_t backoff = _err_stat.backoff_ms * 2U;
+            _err_stat.backoff_ms   = backoff > BUS_OFF_BACKOFF_MAX_MS
+                                         ? BUS_OFF_BACKOFF_MAX_MS
+                                         : backoff;
+        }
+        else
+        {
+            _err_stat.backoff_ms = BUS_OFF_BACKOFF_MIN_MS;
+        }
+        _err_stat.bus_off_tick    = now;
+        _err_stat.bus_off_pending = true;
+    }
+    return pyro::PYRO_OK;
+}
+
+/**
+ * @brief Leaves bus-off once the backoff has elapsed by clearing CCCR.INIT;
+ * the core rejoins after 128 x 11 recessive bits. Runs from the send and
+ * query paths, so it needs no timer.
+ */
+void can_drv_t::recover_bus_off()
+{
+    UBaseType_t irq_state = taskENTER_CRITICAL_FROM_ISR();
+    if (_err_stat.bus_off_pending &&
+        HAL_GetTick() - _err_stat.bus_off_tick >= _err_stat.backoff_ms)
     {
-        // xSemaphoreGive(_registermtx);
+        CLEAR_BIT(_hfdcan->Instance->CCCR, FDCAN_CCCR_INIT);
+        _err_stat.bus_off_pending = false;
+        _err_stat.recover_tick    = HAL_GetTick();
+        _err_stat.bus_off_recoveries++;
+    }
+    taskEXIT_CRITICAL_FROM_ISR(irq_state);
+}
+
+/**
+ * @brief Fills the bus health snapshot (task context). Also drives bus-off
+ * recovery when no frames are being sent.
+ */
+pyro::status_t can_drv_t::get_bus_stat(bus_stat_t &stat)
+{
+    FDCAN_ErrorCountersTypeDef counters;
+    FDCAN_ProtocolStatusTypeDef protocol_status;
+
+    if (_err_stat.bus_off_pending)
+        recover_bus_off();
+    if (HAL_OK != HAL_FDCAN_GetErrorCounters(_hfdcan, &counters) ||
+        HAL_OK != HAL_FDCAN_GetProtocolStatus(_hfdcan, &protocol_status))
         return pyro::PYRO_ERROR;
+    if (protocol_status.LastErrorCode != FDCAN_PROTOCOL_ERROR_NONE &&
+        protocol_status.LastErrorCode != FDCAN_PROTOCOL_ERROR_NO_CHANGE)
+        _err_stat.last_error_code = protocol_status.LastErrorCode;
+
+    const uint32_t rx_frames =
+        _rx_batch_stat[0].rx_frames + _rx_batch_stat[1].rx_frames;
+    const uint32_t tx_frames = _tx_stat.tx_complete;
+    const uint32_t bus_bits  = _err_stat.tx_bits + _rx_count[0].bits +
+                              _rx_count[1].bits;
+    const float dt           = dwt_drv_t::get_delta_t(&_stat_cnt_last);
+
+    stat.rx_frames = rx_frames;
+    stat.tx_frames = tx_frames;
+    stat.rx_fps    = dt > 0.0f ? (rx_frames - _stat_rx_last) / dt : 0.0f;
+    stat.tx_fps    = dt > 0.0f ? (tx_frames - _stat_tx_last) / dt : 0.0f;
+    stat.bus_load  = (dt > 0.0f && _bit_rate > 0)
+                         ? (bus_bits - _stat_bits_last) * 100.0f /
+                              (dt * _bit_rate)
+                         : 0.0f;
+    stat.bit_rate  = _bit_rate;
+    stat.tec       = counters.TxErrorCnt;
+    stat.rec       = counters.RxErrorCnt;
+    stat.last_error_code      = _err_stat.last_error_code;
+    stat.error_warning        = protocol_status.Warning;
+    stat.error_passive        = protocol_status.ErrorPassive;
+    stat.bus_off              = protocol_status.BusOff;
+    stat.error_passive_events = _err_stat.error_passive_events;
+    stat.bus_off_events       = _err_stat.bus_off_events;
+    stat.bus_off_recoveries   = _err_stat.bus_off_recoveries;
+    stat.bus_off_backoff_ms   = _err_stat.backoff_ms;
+
+    _stat_rx_last   = rx_frames;
+    _stat_tx_last   = tx_frames;
+    _stat_bits_last = bus_bits;
+    return pyro::PYRO_OK;
+}
+
+const can_latency_hist_t &can_drv_t::get_feedback_age_hist() const
+{
+    return _feedback_age_hist;
+}
+
+const can_latency_hist_t &can_drv_t::get_tx_latency_hist() const
+{
+    return _tx_latency_hist;
+}
+
+void can_drv_t::reset_latency_hist()
+{
+    _feedback_age_hist.reset();
+    _tx_latency_hist.reset();
+    _rx_latency.reset();
+}
+
+const latency_path_t &can_drv_t::get_rx_latency() const
+{
+    return _rx_latency;
+}
+
+uint8_t can_drv_t::get_tx_pending(tx_priority_t priority) const
+{
+    if (priority >= TX_PRIO_NUM)
+        return 0;
+    return _tx_queue[priority].count;
+}
+
+/**
+ * @brief Switches this bus to CAN-FD with bit-rate switching and 64-byte
+ * message RAM elements (task context, before start()).
+ *
+ * Re-initialises the peripheral, so filters are reprogrammed here. The FD
+ * layout has no RX buffers or TX buffers, and has to fit below
+ * the next FDCAN instance's MessageRAMOffset. With the CubeMX offsets only
+ * FDCAN3 has room. Classic-only nodes must not share an FD bus.
+ */
+pyro::status_t can_drv_t::config_fd(const fd_config_t &config)
+{
+    constexpr uint32_t ram_words   = 0x2800U / 4U;
+    constexpr uint32_t elmt_words  = 2U + 64U / 4U;
+    if (HAL_FDCAN_STATE_READY != _hfdcan->State)
+        return pyro::PYRO_BUSY;
+    if (0 == config.data_prescaler || 0 == config.rx_fifo_elmts ||
+        config.rx_fifo_elmts > 64 || config.rx_fifo1_elmts > 64 ||
+        0 == config.tx_fifo_elmts ||
+        config.tx_fifo_elmts > 32)
+        return pyro::PYRO_PARAM_ERROR;
+
+    uint32_t ram_limit = ram_words;
+    for (FDCAN_HandleTypeDef *other : {&hfdcan1, &hfdcan2, &hfdcan3})
+    {
+        const uint32_t offset = other->Init.MessageRAMOffset;
+        if (other != _hfdcan && offset > _hfdcan->Init.MessageRAMOffset &&
+            offset < ram_limit)
+            ram_limit = offset;
     }
-    this->_registerlist[id] = msg_buffer;
-    // xSemaphoreGive(_registermtx);
+    const uint32_t ram_needed =
+        _hfdcan->Init.StdFiltersNbr + 2U * _hfdcan->Init.ExtFiltersNbr +
+        elmt_words * (config.rx_fifo_elmts + config.rx_fifo1_elmts +
+                      config.tx_fifo_elmts);
+    if (_hfdcan->Init.MessageRAMOffset + ram_needed > ram_limit)
+        return pyro::PYRO_NO_MEMORY;
+
+    if (HAL_OK != HAL_FDCAN_DeInit(_hfdcan))
+        return pyro::PYRO_ERROR;
+    _hfdcan->Init.FrameFormat         = FDCAN_FRAME_FD_BRS;
+    _hfdcan->Init.DataPrescaler       = config.data_prescaler;
+    _hfdcan->Init.DataTimeSeg1        = config.data_seg1;
+    _hfdcan->Init.DataTimeSeg2        = config.data_seg2;
+    _hfdcan->Init.DataSyncJumpWidth   = config.data_sjw;
+    _hfdcan->Init.RxFifo0ElmtsNbr     = config.rx_fifo_elmts;
+    _hfdcan->Init.RxFifo0ElmtSize     = FDCAN_DATA_BYTES_64;
+    _hfdcan->Init.RxFifo1ElmtsNbr     = config.rx_fifo1_elmts;
+    _hfdcan->Init.RxFifo1ElmtSize     = FDCAN_DATA_BYTES_64;
+    _hfdcan->Init.RxBuffersNbr        = 0;
+    _hfdcan->Init.TxEventsNbr         = 0;
+    _hfdcan->Init.TxBuffersNbr        = 0;
+    _hfdcan->Init.TxFifoQueueElmtsNbr = config.tx_fifo_elmts;
+    _hfdcan->Init.TxElmtSize          = FDCAN_DATA_BYTES_64;
+    if (HAL_OK != HAL_FDCAN_Init(_hfdcan))
+        return pyro::PYRO_ERROR;
+
+    // Transceiver loop delay: sample the TX bit one data sample point late
+    if (HAL_OK != HAL_FDCAN_ConfigTxDelayCompensation(
+                      _hfdcan, config.data_prescaler * config.data_seg1, 0))
+        return pyro::PYRO_ERROR;
+    if (HAL_OK != HAL_FDCAN_EnableTxDelayCompensation(_hfdcan))
+        return pyro::PYRO_ERROR;
+
+    const uint32_t nominal_tq =
+        _hfdcan->Init.NominalPrescaler * (1U + _hfdcan->Init.NominalTimeSeg1 +
+                                          _hfdcan->Init.NominalTimeSeg2);
+    const uint32_t data_tq =
+        config.data_prescaler * (1U + config.data_seg1 + config.data_seg2);
+    _fd_bit_ratio = data_tq ? nominal_tq / data_tq : 1;
+    if (0 == _fd_bit_ratio)
+        _fd_bit_ratio = 1;
+    _fd_enabled = true;
+
+    if (_rx_watermark > config.rx_fifo_elmts)
+        _rx_watermark = config.rx_fifo_elmts;
+    if (pyro::PYRO_OK != config_filters())
+        return pyro::PYRO_ERROR;
+    if (HAL_OK !=
+        HAL_FDCAN_ConfigGlobalFilter(_hfdcan, FDCAN_REJECT, FDCAN_REJECT,
+                                     FDCAN_REJECT_REMOTE, FDCAN_REJECT_REMOTE))
+        return pyro::PYRO_ERROR;
     return pyro::PYRO_OK;
-    // }
-    // return pyro::PYRO_ERROR;
 }
 
-pyro::status_t can_drv_t::handle_rx_msg(uint32_t id,
-                                        uint8_t *data) // mutex or not
+bool can_drv_t::is_fd() const
 {
-    // if(xSemaphoreTake(_registermtx,portMAX_DELAY)==pdTRUE)
-    // {
-    if (!this->_registerlist.exist(id))
+    return _fd_enabled;
+}
+
+/**
+ * @brief Sends one FD frame with BRS. The payload is zero padded to the
+ * next valid FD length. Goes straight to the HW FIFO: an FD link carries
+ * latest-state packets, so a full FIFO drops the frame instead of queueing.
+ * Counted in tx_stat_t::fd_sent / fd_dropped, apart from the queued classes.
+ */
+pyro::status_t can_drv_t::send_fd_msg(uint32_t id, const uint8_t *data,
+                                      uint8_t len)
+{
+    if (!_fd_enabled)
+        return pyro::PYRO_ERROR;
+    if (nullptr == data || id >= MAX_STD_ID_NUM || len > FD_MAX_DATA_LEN)
+        return pyro::PYRO_PARAM_ERROR;
+    if (_err_stat.bus_off_pending)
+        recover_bus_off();
+
+    const uint32_t dlc = fd_len_to_dlc(len);
+    uint8_t frame[FD_MAX_DATA_LEN];
+    memcpy(frame, data, len);
+    memset(frame + len, 0, fd_dlc_to_len(dlc) - len);
+
+    FDCAN_TxHeaderTypeDef tx_header;
+    tx_header.Identifier          = id;
+    tx_header.IdType              = FDCAN_STANDARD_ID;
+    tx_header.TxFrameType         = FDCAN_DATA_FRAME;
+    tx_header.DataLength          = dlc;
+    tx_header.ErrorStateIndicator = FDCAN_ESI_ACTIVE;
+    tx_header.BitRateSwitch       = FDCAN_BRS_ON;
+    tx_header.FDFormat            = FDCAN_FD_CAN;
+    tx_header.TxEventFifoControl  = FDCAN_NO_TX_EVENTS;
+    tx_header.MessageMarker       = 0;
+
+    const uint32_t enqueue_cnt = dwt_drv_t::get_current_ticks();
+    UBaseType_t irq_state      = taskENTER_CRITICAL_FROM_ISR();
+    if (0 == HAL_FDCAN_GetTxFifoFreeLevel(_hfdcan) ||
+        HAL_OK != HAL_FDCAN_AddMessageToTxFifoQ(_hfdcan, &tx_header, frame))
     {
-        // xSemaphoreGive(_registermtx);
+        _tx_stat.fd_dropped++;
+        taskEXIT_CRITICAL_FROM_ISR(irq_state);
+        return pyro::PYRO_BUSY;
+    }
+    mark_tx_inflight(enqueue_cnt,
+                     fd_frame_bits(fd_dlc_to_len(dlc), _fd_bit_ratio));
+    _tx_stat.fd_sent++;
+    taskEXIT_CRITICAL_FROM_ISR(irq_state);
+    return pyro::PYRO_OK;
+}
+
+/**
+ * @brief Routes FD frames with this ID to handler (one receiver per bus).
+ */
+pyro::status_t can_drv_t::register_fd_rx(uint32_t id, fd_rx_handler_t handler,
+                                         void *ctx)
+{
+    if (nullptr == handler || id >= MAX_STD_ID_NUM)
+        return pyro::PYRO_PARAM_ERROR;
+    if (nullptr != _fd_rx_handler || _registerlist.exist(id))
+        return pyro::PYRO_ERROR;
+    _fd_rx_ctx     = ctx;
+    _fd_rx_id      = static_cast<uint16_t>(id);
+    std::atomic_signal_fence(std::memory_order_release);
+    _fd_rx_handler = handler;
+    return config_filters();
+}
+
+uint8_t can_drv_t::fd_dlc_to_len(uint32_t dlc)
+{
+    static constexpr uint8_t len[16] = {0,  1,  2,  3,  4,  5,  6,  7,
+                                        8, 12, 16, 20, 24, 32, 48, 64};
+    return len[dlc & 0x0FU];
+}
+
+uint32_t can_drv_t::fd_len_to_dlc(uint8_t len)
+{
+    uint32_t dlc = 0;
+    while (dlc < 15U && fd_dlc_to_len(dlc) < len)
+        dlc++;
+    return dlc;
+}
+
+uint32_t can_drv_t::frame_bits(const FDCAN_RxHeaderTypeDef &header) const
+{
+    if (FDCAN_FD_CAN == header.FDFormat)
+        return fd_frame_bits(fd_dlc_to_len(header.DataLength),
+                             FDCAN_BRS_ON == header.BitRateSwitch
+                                 ? _fd_bit_ratio
+                                 : 1U);
+    return std_frame_bits(header.DataLength);
+}
+
+/**
+ * @brief Registers a buffer for its ID. priority selects the RX FIFO, and
+ * with it the interrupt line, that the ID is filtered into.
+ */
+pyro::status_t can_drv_t::register_rx_msg(can_msg_buffer_t *msg_buffer,
+                                          rx_priority_t priority)
+{
+    if (nullptr == msg_buffer)
+        return pyro::PYRO_PARAM_ERROR;
+    uint32_t id = msg_buffer->get_id();
+    if (id >= MAX_STD_ID_NUM)
+        return pyro::PYRO_PARAM_ERROR;
+    if (RX_PRIO_LOW == priority && 0 == _hfdcan->Init.RxFifo1ElmtsNbr)
+        return pyro::PYRO_PARAM_ERROR;
+    if (this->_registerlist.exist(id) || id == _fd_rx_id)
+        return pyro::PYRO_ERROR;
+    if (this->_registerlist.full())
+        return pyro::PYRO_NO_MEMORY;
+    if (!this->_registerlist.insert(id, msg_buffer))
+        return pyro::PYRO_ERROR;
+    _rx_low_prio.set(id, RX_PRIO_LOW == priority);
+    msg_buffer->attach_age_hist(&_feedback_age_hist);
+    msg_buffer->attach_latency(&_rx_latency);
+    return config_filters();
+}
+
+pyro::status_t can_drv_t::unregister_rx_msg(can_msg_buffer_t *msg_buffer)
+{
+    if (nullptr == msg_buffer)
+        return pyro::PYRO_PARAM_ERROR;
+    uint32_t id = msg_buffer->get_id();
+    if (this->_registerlist.lookup(id) != msg_buffer ||
+        !this->_registerlist.erase(id))
         return pyro::PYRO_NOT_FOUND;
+    msg_buffer->attach_age_hist(nullptr);
+    msg_buffer->attach_latency(nullptr);
+    _rx_low_prio.reset(id);
+    return config_filters();
+}
+
+pyro::status_t can_drv_t::handle_rx_msg(uint32_t id, uint8_t *data) // ISR
+{
+    // External entry point, counted with FIFO0
+    const pyro::status_t status =
+        handle_rx_msg(id, data, dwt_drv_t::get_current_ticks());
+    _rx_count[0].accepted++;
+    if (pyro::PYRO_NOT_FOUND == status)
+        _rx_count[0].unmatched++;
+    return status;
+}
+
+pyro::status_t can_drv_t::handle_rx_msg(uint32_t id, uint8_t *data,
+                                        uint32_t timestamp) // ISR
+{
+    can_msg_buffer_t *msg = this->_registerlist.lookup(id);
+    if (nullptr == msg)
+        return pyro::PYRO_NOT_FOUND;
+    msg->update_data(data, timestamp);
+    return pyro::PYRO_OK;
+}
+
+/**
+ * @brief Drains every pending element of an RX FIFO in one pass (ISR).
+ *
+ * Bounded by the FIFO size so a flooded bus cannot pin the CPU here.
+ */
+pyro::status_t can_drv_t::handle_rx_fifo(uint32_t rx_fifo)
+{
+    FDCAN_RxHeaderTypeDef rx_header;
+    uint8_t data[FD_MAX_DATA_LEN];
+    uint16_t frames = 0;
+    const uint32_t fifo_size = (FDCAN_RX_FIFO0 == rx_fifo)
+                                   ? _hfdcan->Init.RxFifo0ElmtsNbr
+                                   : _hfdcan->Init.RxFifo1ElmtsNbr;
+
+    // Pair DWT with the FDCAN timestamp once, then back-date every frame
+    // by the bit times it spent in the FIFO
+    const uint32_t entry_cnt = dwt_drv_t::get_current_ticks();
+    const uint16_t entry_tsc = HAL_FDCAN_GetTimestampCounter(_hfdcan);
+
+    const uint8_t fifo_idx      = FDCAN_RX_FIFO0 == rx_fifo ? 0 : 1;
+    rx_batch_stat_t &batch_stat = _rx_batch_stat[fifo_idx];
+    rx_count_t &count           = _rx_count[fifo_idx];
+    batch_stat.isr_entry++;
+    while (frames < fifo_size &&
+           HAL_FDCAN_GetRxFifoFillLevel(_hfdcan, rx_fifo) > 0)
+    {
+        if (HAL_OK !=
+            HAL_FDCAN_GetRxMessage(_hfdcan, rx_fifo, &rx_header, data))
+            break;
+        frames++;
+        count.bits += frame_bits(rx_header);
+        if (FDCAN_DATA_FRAME != rx_header.RxFrameType ||
+            FDCAN_STANDARD_ID != rx_header.IdType)
+            continue;
+
+        uint16_t wait_bits =
+            static_cast<uint16_t>(entry_tsc - rx_header.RxTimestamp);
+        if (wait_bits > 0x8000U) // Arrived after entry
+            wait_bits = 0;
+        const uint32_t timestamp = entry_cnt - wait_bits * _cyc_per_bit;
+
+        if (FDCAN_FD_CAN != rx_header.FDFormat)
+        {
+            count.accepted++;
+            if (pyro::PYRO_NOT_FOUND ==
+                handle_rx_msg(rx_header.Identifier, data, timestamp))
+                count.unmatched++;
+        }
+        else if (nullptr != _fd_rx_handler &&
+                 rx_header.Identifier == _fd_rx_id)
+        {
+            _fd_rx_handler(_fd_rx_ctx, rx_header.Identifier, data,
+                           fd_dlc_to_len(rx_header.DataLength), timestamp);
+        }
     }
-    can_msg_buffer_t *msg = this->_registerlist[id];
-    msg->update_data(data);
-    // xSemaphoreGive(_registermtx);
+    batch_stat.rx_frames += frames;
+    if (frames > batch_stat.max_frames_entry)
+        batch_stat.max_frames_entry = frames;
     return pyro::PYRO_OK;
-    // }
-    // return pyro::PYRO_ERROR;
 }
 
-can_hub_t::can_hub_t() : _can_drv_map()
+can_drv_t::filter_stat_t can_drv_t::get_filter_stat() const
+{
+    filter_stat_t stat = _filter_stat;
+    stat.rx_accepted   = _rx_count[0].accepted + _rx_count[1].accepted;
+    stat.rx_unmatched  = _rx_count[0].unmatched + _rx_count[1].unmatched;
+    return stat;
+}
+
+const can_drv_t::rx_batch_stat_t &
+can_drv_t::get_rx_batch_stat(uint32_t rx_fifo) const
+{
+    return _rx_batch_stat[FDCAN_RX_FIFO0 == rx_fifo ? 0 : 1];
+}
+
+/**
+ * @brief Rebuilds the standard-ID filter list in message RAM from the
+ * registered rx buffers (task context).
+ *
+ * Consecutive IDs of the same RX class (e.g. DJI feedback 0x201-0x20B)
+ * collapse into one range element, remaining single IDs are packed two per
+ * dual-ID element of their class. Each element stores to FIFO0 or FIFO1 by
+ * class. If the list does not fit into StdFiltersNbr, element 0 falls back
+ * to an accept-all mask into FIFO0 and dispatch relies on the software
+ * table alone.
+ */
+pyro::status_t can_drv_t::config_filters(void)
+{
+    struct id_run_t
+    {
+        uint16_t first;
+        uint16_t last;
+        uint8_t fifo;
+    };
+    std::array<id_run_t, MAX_ID_REGIST_NUM + 1> runs; // + FD link ID
+    uint8_t run_num    = 0;
+    std::array<uint8_t, 2> single_num{};
+
+    // Registered IDs in ascending order, merged into runs per class
+    for (uint16_t id = 0; id < MAX_STD_ID_NUM; id++)
+    {
+        if (!_registerlist.exist(id) && id != _fd_rx_id)
+            continue;
+        const uint8_t fifo = _rx_low_prio.test(id) ? 1 : 0;
+        if (run_num > 0 && runs[run_num - 1].last + 1 == id &&
+            runs[run_num - 1].fifo == fifo)
+        {
+            if (runs[run_num - 1].first == runs[run_num - 1].last)
+                single_num[fifo]--;
+            runs[run_num - 1].last = id;
+        }
+        else
+        {
+            runs[run_num++] = {id, id, fifo};
+            single_num[fifo]++;
+        }
+    }
+
+    const uint8_t filter_num = _hfdcan->Init.StdFiltersNbr;
+    const uint8_t filter_needed =
+        (run_num - single_num[0] - single_num[1]) +
+        (single_num[0] + 1) / 2 + (single_num[1] + 1) / 2;
+
+    FDCAN_FilterTypeDef fdcan_filter;
+    fdcan_filter.IdType       = FDCAN_STANDARD_ID;
+    fdcan_filter.FilterConfig = FDCAN_FILTER_TO_RXFIFO0;
+    uint8_t index             = 0;
+
+    if (filter_needed > filter_num)
+    {
+        fdcan_filter.FilterIndex = index++;
+        fdcan_filter.FilterType  = FDCAN_FILTER_MASK;
+        fdcan_filter.FilterID1   = 0x00;
+        fdcan_filter.FilterID2   = 0x00;
+        if (HAL_OK != HAL_FDCAN_ConfigFilter(_hfdcan, &fdcan_filter))
+            return pyro::PYRO_ERROR;
+    }
+    else
+    {
+        static constexpr uint32_t fifo_config[2] = {FDCAN_FILTER_TO_RXFIFO0,
+                                                    FDCAN_FILTER_TO_RXFIFO1};
+        std::array<int32_t, 2> single_pending = {-1, -1};
+        for (uint8_t i = 0; i < run_num; i++)
+        {
+            const uint8_t fifo        = runs[i].fifo;
+            fdcan_filter.FilterConfig = fifo_config[fifo];
+            if (runs[i].first != runs[i].last)
+            {
+                fdcan_filter.FilterIndex = index++;
+                fdcan_filter.FilterType  = FDCAN_FILTER_RANGE;
+                fdcan_filter.FilterID1   = runs[i].first;
+                fdcan_filter.FilterID2   = runs[i].last;
+            }
+            else if (single_pending[fifo] < 0)
+            {
+                single_pending[fifo] = runs[i].first;
+                continue;
+            }
+            else
+            {
+                fdcan_filter.FilterIndex = index++;
+                fdcan_filter.FilterType  = FDCAN_FILTER_DUAL;
+                fdcan_filter.FilterID1   = single_pending[fifo];
+                fdcan_filter.FilterID2   = runs[i].first;
+                single_pending[fifo]     = -1;
+            }
+            if (HAL_OK != HAL_FDCAN_ConfigFilter(_hfdcan, &fdcan_filter))
+                return pyro::PYRO_ERROR;
+        }
+        for (uint8_t fifo = 0; fifo < 2; fifo++)
+        {
+            if (single_pending[fifo] < 0)
+                continue;
+            fdcan_filter.FilterIndex  = index++;
+            fdcan_filter.FilterConfig = fifo_config[fifo];
+            fdcan_filter.FilterType   = FDCAN_FILTER_DUAL;
+            fdcan_filter.FilterID1    = single_pending[fifo];
+            fdcan_filter.FilterID2    = single_pending[fifo];
+            if (HAL_OK != HAL_FDCAN_ConfigFilter(_hfdcan, &fdcan_filter))
+                return pyro::PYRO_ERROR;
+        }
+    }
+
+    _filter_stat.filter_used = index;
+    _filter_stat.filter_num  = filter_num;
+    _filter_stat.accept_all  = filter_needed > filter_num;
+
+    // Disable the remaining elements left over from a previous layout
+    fdcan_filter.FilterConfig = FDCAN_FILTER_DISABLE;
+    fdcan_filter.FilterType   = FDCAN_FILTER_DUAL;
+    fdcan_filter.FilterID1    = 0x00;
+    fdcan_filter.FilterID2    = 0x00;
+    for (; index < filter_num; index++)
+    {
+        fdcan_filter.FilterIndex = index;
+        if (HAL_OK != HAL_FDCAN_ConfigFilter(_hfdcan, &fdcan_filter))
+            return pyro::PYRO_ERROR;
+    }
+    return pyro::PYRO_OK;
+}
+
+can_hub_t::can_hub_t()
 { // Log
-    this->_can_drv_map.clear();
 }
 
 can_hub_t *can_hub_t::_instancePtr = nullptr;
@@ -183,42 +1011,56 @@ can_hub_t *can_hub_t::get_instance(void)
     }
     return _instancePtr;
 }
+
+/**
+ * @brief Slot of a HAL handle in _can_drv, -1 if it is not one of the
+ * CubeMX handles hfdcan1..3. Compares addresses, so it also works before
+ * MX_FDCANx_Init() has filled in the instance.
+ */
+int8_t can_hub_t::slot_of(const FDCAN_HandleTypeDef *hfdcan)
+{
+    if (&hfdcan1 == hfdcan)
+        return can1;
+    if (&hfdcan2 == hfdcan)
+        return can2;
+    if (&hfdcan3 == hfdcan)
+        return can3;
+    return -1;
+}
+
+/**
+ * @brief Driver of a HAL handle, nullptr if none is registered (ISR-safe).
+ */
+can_drv_t *can_hub_t::lookup(const FDCAN_HandleTypeDef *hfdcan) const
+{
+    const int8_t slot = slot_of(hfdcan);
+    return slot < 0 ? nullptr : _can_drv[slot];
+}
+
 pyro::status_t can_hub_t::hub_register_can_obj(FDCAN_HandleTypeDef *hfdcan,
                                                can_drv_t *can_drv)
 {
-    if (this->_can_drv_map.exist(hfdcan))
+    const int8_t slot = slot_of(hfdcan);
+    if (slot < 0 || nullptr != _can_drv[slot])
         return PYRO_ERROR;
-    this->_can_drv_map[hfdcan] = can_drv;
+    _can_drv[slot] = can_drv;
     return pyro::PYRO_OK;
 }
 
 status_t can_hub_t::hub_unregister_can_obj(FDCAN_HandleTypeDef *hfdcan)
 {
-    if (!this->_can_drv_map.exist(hfdcan))
+    const int8_t slot = slot_of(hfdcan);
+    if (slot < 0 || nullptr == _can_drv[slot])
         return pyro::PYRO_ERROR;
-    this->_can_drv_map.erase(hfdcan);
+    _can_drv[slot] = nullptr;
     return pyro::PYRO_OK;
 }
 
 can_drv_t *can_hub_t::hub_get_can_obj(which_can which_can)
 {
-    FDCAN_HandleTypeDef *hfdcan = nullptr;
-    switch (which_can)
-    {
-        case can1:
-            hfdcan = &hfdcan1;
-            break;
-        case can2:
-            hfdcan = &hfdcan2;
-            break;
-        case can3:
-            hfdcan = &hfdcan3;
-            break;
-        default:
-            return nullptr;
-    }
-    can_drv_t *can_drv = this->_can_drv_map[hfdcan];
-    return can_drv;
+    if (which_can < can1 || which_can >= can_num)
+        return nullptr;
+    return _can_drv[which_can];
 }
 //    pyro::status_t hub_unregister_can_client(which_can which_can,uint32_t id);
 
@@ -226,10 +1068,38 @@ pyro::status_t can_hub_t::hub_handle_callback(FDCAN_HandleTypeDef *hfdcan,
                                               uint32_t identifier,
                                               uint8_t *data)
 {
-    if (!this->_can_drv_map.exist(hfdcan))
+    can_drv_t *can_drv = lookup(hfdcan);
+    if (nullptr == can_drv)
+        return pyro::PYRO_ERROR;
+    return can_drv->handle_rx_msg(identifier, data);
+}
+
+pyro::status_t can_hub_t::hub_handle_rx_fifo(FDCAN_HandleTypeDef *hfdcan,
+                                             uint32_t rx_fifo)
+{
+    can_drv_t *can_drv = lookup(hfdcan);
+    if (nullptr == can_drv)
+        return pyro::PYRO_ERROR;
+    return can_drv->handle_rx_fifo(rx_fifo);
+}
+
+pyro::status_t can_hub_t::hub_handle_tx_complete(FDCAN_HandleTypeDef *hfdcan,
+                                                 uint32_t buffer_indexes)
+{
+    can_drv_t *can_drv = lookup(hfdcan);
+    if (nullptr == can_drv)
+        return pyro::PYRO_ERROR;
+    return can_drv->handle_tx_complete(buffer_indexes);
+}
+
+pyro::status_t
+can_hub_t::hub_handle_error_status(FDCAN_HandleTypeDef *hfdcan,
+                                   uint32_t error_status_its)
+{
+    can_drv_t *can_drv = lookup(hfdcan);
+    if (nullptr == can_drv)
         return pyro::PYRO_ERROR;
-    // return this->_can_drv_map[hfdcan]->hub_handle_callback(hfdcan, data);
-    return this->_can_drv_map[hfdcan]->handle_rx_msg(identifier, data);
+    return can_drv->handle_error_status(error_status_its);
 }
 
 }; // namespace pyro
@@ -241,28 +1111,38 @@ void can_global_handle(FDCAN_HandleTypeDef *hfdcan, uint32_t identifier,
                                                          data);
 }
 
-FDCAN_RxHeaderTypeDef rx_header;
-uint32_t a;
 extern "C" void HAL_FDCAN_RxFifo0Callback(FDCAN_HandleTypeDef *hfdcan,
                                           uint32_t RxFifo0ITs)
 {
+    PYRO_PROFILE_SCOPE("can_rx_fifo0");
+    pyro::can_hub_t::get_instance()->hub_handle_rx_fifo(hfdcan,
+                                                        FDCAN_RX_FIFO0);
+}
 
-    uint8_t data[8];
-    if (HAL_OK !=
-        HAL_FDCAN_GetRxMessage(hfdcan, FDCAN_RX_FIFO0, &rx_header, data))
-    {
-        return;
-    }
-    if (FDCAN_FRAME_CLASSIC == rx_header.RxFrameType &&
-        FDCAN_STANDARD_ID == rx_header.IdType)
-    {
-        if (hfdcan == &hfdcan1)
-            a++;
-        else if (hfdcan == &hfdcan2)
-            a--;
-        else if (hfdcan == &hfdcan3)
-            a;
-
-        can_global_handle(hfdcan, rx_header.Identifier, data);
-    }
-}
\ No newline at end of file
+extern "C" void HAL_FDCAN_RxFifo1Callback(FDCAN_HandleTypeDef *hfdcan,
+                                          uint32_t RxFifo1ITs)
+{
+    pyro::can_hub_t::get_instance()->hub_handle_rx_fifo(hfdcan,
+                                                        FDCAN_RX_FIFO1);
+}
+
+extern "C" void HAL_FDCAN_TimeoutOccurredCallback(FDCAN_HandleTypeDef *hfdcan)
+{
+    // Batch timeout: frames below the watermark waited long enough
+    pyro::can_hub_t::get_instance()->hub_handle_rx_fifo(hfdcan,
+                                                        FDCAN_RX_FIFO0);
+}
+
+extern "C" void HAL_FDCAN_TxBufferCompleteCallback(FDCAN_HandleTypeDef *hfdcan,
+                                                   uint32_t BufferIndexes)
+{
+    pyro::can_hub_t::get_instance()->hub_handle_tx_complete(hfdcan,
+                                                            BufferIndexes);
+}
+
+extern "C" void HAL_FDCAN_ErrorStatusCallback(FDCAN_HandleTypeDef *hfdcan,
+                                              uint32_t ErrorStatusITs)
+{
+    pyro::can_hub_t::get_instance()->hub_handle_error_status(hfdcan,
+                                                             ErrorStatusITs);
+}
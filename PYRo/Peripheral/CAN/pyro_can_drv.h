@@ -5,51 +5,327 @@
 #include "pyro_core_def.h"
 
 #include <array>
+#include <bitset>
 #include <cmsis_os.h>
 
-#include "map.h"
+#include "direct_map.h"
+#include "histogram.h"
+#include "pyro_latency.h"
 
 namespace pyro
 {
+using can_latency_hist_t = histogram_t<16>; // Microseconds, up to 16 ms
+
+/**
+ * @brief Latest-value buffer for one CAN ID, written from the RX ISR.
+ *
+ * Uses a sequence lock: the ISR bumps _seq to odd, writes the frame and
+ * bumps it back to even. Readers retry until they copy under an even,
+ * unchanged sequence, so an 8-byte read never mixes two frames and neither
+ * side disables interrupts or takes a mutex. _seq / 2 is the number of
+ * frames received so far (generation).
+ */
 class can_msg_buffer_t
 {
   public:
+    /**
+     * @brief Consistent copy of the latest frame.
+     *
+     * Each consumer keeps its own snapshot_t across read() calls: the
+     * generation it holds is that consumer's read position, so several
+     * tasks can read one buffer without stealing each other's frames.
+     */
+    struct snapshot_t
+    {
+        std::array<uint8_t, 8> data;
+        uint32_t generation; // Frames received up to this one, 0 = none
+        uint32_t timestamp;  // DWT CYCCNT captured in the RX ISR
+        uint32_t dropped;    // Frames overwritten since the previous read()
+        float age;           // Seconds between reception and read()
+    };
+
     explicit can_msg_buffer_t(uint32_t id);
     ~can_msg_buffer_t();
 
     uint32_t get_id();
-    bool is_fresh();
-    void mark_read();
+    bool is_fresh();  // Single consumer, separate from read()
+    void mark_read(); // Single consumer, separate from read()
     void update_data(const uint8_t *data);
+    void update_data(const uint8_t *data, uint32_t timestamp);
+    void attach_age_hist(can_latency_hist_t *hist);
+    void attach_latency(latency_path_t *path);
     bool get_data(std::array<uint8_t, 8> &data);
+    bool read(snapshot_t &snapshot);
+    uint32_t get_generation();
     TickType_t get_last_update_time();
 
   private:
+    uint32_t load(std::array<uint8_t, 8> &data, uint32_t &timestamp,
+                  TickType_t &tick, uint32_t &write_cnt);
+
     uint32_t _id;
+    volatile uint32_t _seq;       // Odd while the ISR is writing
     std::array<uint8_t, 8> _buffer;
-    volatile bool _is_fresh;
-    TickType_t _last_update_time;
-    SemaphoreHandle_t _mtx;
+    uint32_t _timestamp;          // DWT CYCCNT of the last frame
+    uint32_t _write_cnt;          // DWT CYCCNT when the ISR stored it
+    TickType_t _last_update_time; // RTOS tick of the last frame
+    uint32_t _read_generation;    // Generation seen by mark_read()
+    can_latency_hist_t *_age_hist = nullptr; // Age at first read(), by bus
+    latency_path_t *_latency      = nullptr; // Fresh frames, set by the bus
 };
 
 class can_drv_t
 {
-    const uint8_t MAX_ID_REGIST_NUM = 32;
-    using can_id_regist_t           = uint16_t;
+    static constexpr uint8_t MAX_ID_REGIST_NUM = 64;
+    static constexpr uint16_t MAX_STD_ID_NUM   = 0x800; // 11-bit standard ID
+    static constexpr uint8_t TX_QUEUE_DEPTH    = 16;    // Per priority class
+    static constexpr uint16_t BUS_OFF_BACKOFF_MIN_MS = 10;
+    static constexpr uint16_t BUS_OFF_BACKOFF_MAX_MS = 1000;
+    using can_id_regist_t                      = uint16_t;
 
   public:
+    /**
+     * @brief TX priority classes, lower value leaves the bus first.
+     */
+    enum tx_priority_t : uint8_t
+    {
+        TX_PRIO_MOTOR = 0, // Motor current / torque commands
+        TX_PRIO_CONTROL,   // Motor enable / disable, mode switches
+        TX_PRIO_DIAG,      // Diagnostics and everything else
+        TX_PRIO_NUM
+    };
+
+    /**
+     * @brief RX priority classes. RX_PRIO_HIGH IDs land in FIFO0, served by
+     * FDCANx_IT0; RX_PRIO_LOW IDs land in FIFO1, served by FDCANx_IT1 at a
+     * lower NVIC priority, so background bursts cannot delay FIFO0.
+     */
+    enum rx_priority_t : uint8_t
+    {
+        RX_PRIO_HIGH = 0, // Motor feedback and other latency-critical IDs
+        RX_PRIO_LOW       // Supercap, diagnostics, board-to-board status
+    };
+
+    /**
+     * @brief Software TX queue counters, indexed by tx_priority_t.
+     *
+     * FD frames from send_fd_msg() skip the priority queues and are counted
+     * on their own; tx_complete covers both kinds.
+     */
+    struct tx_stat_t
+    {
+        volatile uint32_t tx_sent;                   // Frames moved to HW FIFO
+        volatile uint32_t tx_complete;               // Frames on the bus
+        volatile uint32_t tx_dropped[TX_PRIO_NUM];   // Rejected, queue full
+        volatile uint16_t high_water[TX_PRIO_NUM];   // Max queue depth seen
+        volatile uint32_t fd_sent;                   // FD frames to HW FIFO
+        volatile uint32_t fd_dropped;                // FD frames, HW FIFO full
+    };
+
+    /**
+     * @brief Per-bus RX filter counters.
+     *
+     * The FDCAN core does not count frames dropped by the acceptance filter,
+     * so rejection is observed indirectly: rx_unmatched counts frames that
+     * reached the ISR without a registered buffer, which stays at zero while
+     * the exact filter list is active (accept_all == false). Counts are the
+     * sum over both RX FIFOs.
+     */
+    struct filter_stat_t
+    {
+        volatile uint32_t rx_accepted;  // Frames passed by the HW filter
+        volatile uint32_t rx_unmatched; // ...of which had no rx buffer
+        uint8_t filter_used;            // Standard filter elements in use
+        uint8_t filter_num;             // Standard filter elements available
+        bool accept_all;                // Fallback: accept every std ID
+    };
+
+    /**
+     * @brief RX FIFO drain counters, frames per entry = rx_frames/isr_entry.
+     */
+    struct rx_batch_stat_t
+    {
+        volatile uint32_t isr_entry;        // RX callback invocations
+        volatile uint32_t rx_frames;        // Frames read from the FIFO
+        volatile uint16_t max_frames_entry; // Largest batch in one entry
+    };
+
+    /**
+     * @brief Bus health snapshot returned by get_bus_stat().
+     *
+     * Rates and bus load cover the window since the previous call. Bus load
+     * uses the nominal frame length without stuff bits (lower bound).
+     *
+     * Bus load is the load seen by this node: own TX frames plus the frames
+     * that passed the acceptance filter. Traffic between other nodes that
+     * the filter rejects is not counted, so with the exact filter list
+     * active (accept_all == false) it can be well below the real bus load.
+     */
+    struct bus_stat_t
+    {
+        uint32_t rx_frames;            // Total frames received
+        uint32_t tx_frames;            // Total frames transmitted
+        float rx_fps;                  // Frames per second in the window
+        float tx_fps;
+        float bus_load;                // Percent of nominal bit rate, seen
+                                       // by this node (see above)
+        uint32_t bit_rate;             // Nominal bit rate in bit/s
+        uint8_t tec;                   // Transmit error counter (ECR.TEC)
+        uint8_t rec;                   // Receive error counter (ECR.REC)
+        uint8_t last_error_code;       // FDCAN_PROTOCOL_ERROR_xxx, sticky
+        bool error_warning;            // Counter >= 96
+        bool error_passive;            // Counter >= 128
+        bool bus_off;
+        uint32_t error_passive_events; // Entries into error passive
+        uint32_t bus_off_events;       // Entries into bus-off
+        uint32_t bus_off_recoveries;   // Restarts issued by the driver
+        uint16_t bus_off_backoff_ms;   // Delay before the next restart
+    };
+
+    /**
+     * @brief CAN-FD data phase and message RAM layout for config_fd().
+     * Defaults: 5 Mbit/s data phase from the 120 MHz FDCAN kernel clock.
+     */
+    struct fd_config_t
+    {
+        uint8_t data_prescaler = 1;
+        uint8_t data_seg1      = 17;
+        uint8_t data_seg2      = 6;
+        uint8_t data_sjw       = 6;
+        uint8_t rx_fifo_elmts  = 32; // 64-byte elements
+        uint8_t rx_fifo1_elmts = 8;
+        uint8_t tx_fifo_elmts  = 32;
+    };
+
+    /**
+     * @brief Receiver of CAN-FD frames (ISR). Plain function pointer plus
+     * context, so the driver stores no heap-backed callable.
+     */
+    using fd_rx_handler_t = void (*)(void *ctx, uint32_t id,
+                                     const uint8_t *data, uint8_t len,
+                                     uint32_t timestamp);
+
+    static constexpr uint8_t FD_MAX_DATA_LEN = 64;
+
     explicit can_drv_t(FDCAN_HandleTypeDef *hfdcan);
     ~can_drv_t();
 
     status_t init();
     status_t start();
-    status_t send_msg(uint32_t id, uint8_t *data);
-    status_t register_rx_msg(can_msg_buffer_t *msg_buffer);
+    status_t config_rx_batch(uint8_t watermark, uint16_t timeout_bits);
+    status_t config_tx_cycle_flush(bool enable);
+    status_t send_msg(uint32_t id, uint8_t *data,
+                      tx_priority_t priority = TX_PRIO_MOTOR);
+    status_t flush_tx();
+    status_t config_fd(const fd_config_t &config);
+    bool is_fd() const;
+    status_t send_fd_msg(uint32_t id, const uint8_t *data, uint8_t len);
+    status_t register_fd_rx(uint32_t id, fd_rx_handler_t handler, void *ctx);
+    static uint8_t fd_dlc_to_len(uint32_t dlc);
+    static uint32_t fd_len_to_dlc(uint8_t len);
+    status_t register_rx_msg(can_msg_buffer_t *msg_buffer,
+                             rx_priority_t priority = RX_PRIO_HIGH);
+    status_t unregister_rx_msg(can_msg_buffer_t *msg_buffer);
     status_t handle_rx_msg(uint32_t id, uint8_t *data);
+    status_t handle_rx_msg(uint32_t id, uint8_t *data, uint32_t timestamp);
+    status_t handle_rx_fifo(uint32_t rx_fifo);
+    status_t handle_tx_complete(uint32_t buffer_indexes);
+    status_t handle_error_status(uint32_t error_status_its);
+    status_t get_bus_stat(bus_stat_t &stat);
+    filter_stat_t get_filter_stat() const;
+    const rx_batch_stat_t &
+    get_rx_batch_stat(uint32_t rx_fifo = FDCAN_RX_FIFO0) const;
+    const tx_stat_t &get_tx_stat() const;
+    uint8_t get_tx_pending(tx_priority_t priority) const;
+    const can_latency_hist_t &get_feedback_age_hist() const;
+    const can_latency_hist_t &get_tx_latency_hist() const;
+    void reset_latency_hist();
+    /**
+     * @brief RX path of fresh frames: SOF -> stored by the ISR -> read().
+     * read() both picks the frame up and finishes with it, so the last
+     * stage is always 0.
+     */
+    const latency_path_t &get_rx_latency() const;
 
   private:
+    struct tx_frame_t
+    {
+        uint16_t id;
+        std::array<uint8_t, 8> data;
+        uint32_t enqueue_cnt; // DWT CYCCNT at send_msg()
+    };
+
+    struct tx_queue_t
+    {
+        std::array<tx_frame_t, TX_QUEUE_DEPTH> frames;
+        uint8_t head;
+        uint8_t count;
+    };
+
+    struct err_stat_t
+    {
+        volatile uint32_t tx_bits;              // Nominal bits sent (IT0)
+        volatile uint32_t error_passive_events;
+        volatile uint32_t bus_off_events;
+        volatile uint32_t bus_off_recoveries;
+        volatile uint32_t bus_off_tick;         // HAL tick of last bus-off
+        volatile uint32_t recover_tick;         // HAL tick of last restart
+        volatile uint16_t backoff_ms;
+        volatile uint8_t last_error_code;
+        volatile bool bus_off_pending;          // Restart not issued yet
+    };
+
+    /**
+     * @brief RX counters of one FIFO. FIFO1 is served on the lower-priority
+     * IT1 line and can be preempted by IT0, so each FIFO only ever writes
+     * its own set and readers sum them.
+     */
+    struct rx_count_t
+    {
+        volatile uint32_t accepted;
+        volatile uint32_t unmatched;
+        volatile uint32_t bits; // Nominal bits of every frame drained
+    };
+
+    status_t config_filters();
+    void pump_tx();
+    void recover_bus_off();
+    void mark_tx_inflight(uint32_t enqueue_cnt, uint16_t bits);
+    uint32_t frame_bits(const FDCAN_RxHeaderTypeDef &header) const;
+
     FDCAN_HandleTypeDef *_hfdcan;
-    map_t<uint32_t, can_msg_buffer_t *> _registerlist;
+    // Dense per-bus dispatch table, O(1) lookup in the RX ISR
+    direct_map_t<can_msg_buffer_t *, MAX_STD_ID_NUM, MAX_ID_REGIST_NUM>
+        _registerlist;
+    filter_stat_t _filter_stat{};
+    std::array<rx_batch_stat_t, 2> _rx_batch_stat{}; // FIFO0, FIFO1
+    std::array<rx_count_t, 2> _rx_count{};           // FIFO0, FIFO1
+    std::bitset<MAX_STD_ID_NUM> _rx_low_prio;          // IDs routed to FIFO1
+    uint8_t _rx_watermark = 1; // 1: interrupt on every new frame
+    uint16_t _rx_timeout  = 0; // Batch timeout in CAN bit times
+    std::array<tx_queue_t, TX_PRIO_NUM> _tx_queue{};
+    tx_stat_t _tx_stat{};
+    bool _tx_cycle_flush = false; // Hold motor frames until flush_tx()
+    bool _tx_flushing    = false; // Motor frames released until queue empty
+    err_stat_t _err_stat{};
+    uint32_t _bit_rate    = 0;
+    uint32_t _cyc_per_bit = 0; // DWT cycles per nominal bit
+    uint32_t _cyc_per_us  = 1;
+    can_latency_hist_t _feedback_age_hist; // RX SOF -> first read() by user
+    can_latency_hist_t _tx_latency_hist;   // send_msg() -> TX complete
+    latency_path_t _rx_latency{"can_rx"};
+    std::array<uint32_t, 32> _tx_inflight_cnt{}; // enqueue_cnt per HW buffer
+    std::array<uint16_t, 32> _tx_inflight_bits{}; // Frame length per buffer
+    bool _fd_enabled              = false;
+    uint8_t _fd_bit_ratio         = 1; // Data / nominal bit rate
+    uint16_t _fd_rx_id            = MAX_STD_ID_NUM; // None
+    fd_rx_handler_t _fd_rx_handler = nullptr;
+    void *_fd_rx_ctx              = nullptr;
+    // get_bus_stat() window
+    uint32_t _stat_cnt_last   = 0;
+    uint32_t _stat_bits_last  = 0;
+    uint32_t _stat_rx_last    = 0;
+    uint32_t _stat_tx_last    = 0;
     SemaphoreHandle_t _registermtx;
 };
 
@@ -61,7 +337,8 @@ class can_hub_t
     {
         can1,
         can2,
-        can3
+        can3,
+        can_num
     };
 
     static can_hub_t *get_instance(void);
@@ -73,13 +350,23 @@ class can_hub_t
     can_drv_t *hub_get_can_obj(which_can which_can);
     status_t hub_handle_callback(FDCAN_HandleTypeDef *hfdcan,
                                  uint32_t identifier, uint8_t *data);
+    status_t hub_handle_rx_fifo(FDCAN_HandleTypeDef *hfdcan,
+                                uint32_t rx_fifo);
+    status_t hub_handle_tx_complete(FDCAN_HandleTypeDef *hfdcan,
+                                    uint32_t buffer_indexes);
+    status_t hub_handle_error_status(FDCAN_HandleTypeDef *hfdcan,
+                                     uint32_t error_status_its);
 
   private:
     can_hub_t();
     can_hub_t(const can_hub_t &)            = delete;
     can_hub_t &operator=(const can_hub_t &) = delete;
+    static int8_t slot_of(const FDCAN_HandleTypeDef *hfdcan);
+    can_drv_t *lookup(const FDCAN_HandleTypeDef *hfdcan) const;
+
     static can_hub_t *_instancePtr;
-    map_t<FDCAN_HandleTypeDef *, can_drv_t *> _can_drv_map;
+    // Indexed by which_can, one load per HAL callback
+    std::array<can_drv_t *, can_num> _can_drv{};
 };
 }; // namespace pyro
 
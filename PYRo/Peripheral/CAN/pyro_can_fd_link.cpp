@@ -0,0 +1,114 @@
+#include "pyro_can_fd_link.h"
+
+#include <atomic>
+#include <cstring>
+
+namespace pyro
+{
+can_fd_link_t::can_fd_link_t(can_drv_t *can, uint32_t tx_id, uint32_t rx_id)
+    : _can(can), _tx_id(tx_id), _rx_id(rx_id)
+{
+}
+
+can_fd_link_t::~can_fd_link_t()
+{
+}
+
+/**
+ * @brief Registers the RX side, the bus must be switched to FD first.
+ */
+status_t can_fd_link_t::init()
+{
+    if (nullptr == _can || !_can->is_fd())
+        return PYRO_ERROR;
+    return _can->register_fd_rx(_rx_id, rx_handler, this);
+}
+
+status_t can_fd_link_t::send_raw(uint8_t type, const void *payload,
+                                 uint8_t len)
+{
+    if (type >= MAX_TYPE_NUM || nullptr == payload || len > MAX_PAYLOAD)
+        return PYRO_PARAM_ERROR;
+
+    uint8_t frame[can_drv_t::FD_MAX_DATA_LEN];
+    frame[0] = type;
+    frame[1] = _tx_seq[type];
+    memcpy(frame + HEADER_LEN, payload, len);
+
+    const status_t status = _can->send_fd_msg(_tx_id, frame, HEADER_LEN + len);
+    if (PYRO_OK != status)
+    {
+        _stat.tx_dropped++;
+        return status;
+    }
+    _tx_seq[type]++;
+    _stat.tx_frames++;
+    return PYRO_OK;
+}
+
+/**
+ * @brief Copies the latest packet of a type. Returns false if none has
+ * arrived yet or the received payload is shorter than len.
+ */
+bool can_fd_link_t::read_raw(uint8_t type, void *payload, uint8_t len,
+                             rx_info_t *info)
+{
+    if (type >= MAX_TYPE_NUM || nullptr == payload || len > MAX_PAYLOAD)
+        return false;
+
+    rx_slot_t &slot = _rx_slot[type];
+    uint32_t lock;
+    uint8_t rx_len;
+    rx_info_t rx_info;
+    do
+    {
+        lock = slot.lock;
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+        rx_len            = slot.len;
+        rx_info.seq       = slot.seq;
+        rx_info.timestamp = slot.timestamp;
+        memcpy(payload, slot.payload.data(), len);
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+    } while ((lock & 0x01U) || lock != slot.lock);
+
+    rx_info.fresh  = lock != slot.read_lock;
+    slot.read_lock = lock;
+    if (nullptr != info)
+        *info = rx_info;
+    return 0 != lock && rx_len >= len;
+}
+
+const can_fd_link_t::link_stat_t &can_fd_link_t::get_stat() const
+{
+    return _stat;
+}
+
+void can_fd_link_t::rx_handler(void *ctx, uint32_t id, const uint8_t *data,
+                               uint8_t len, uint32_t timestamp)
+{
+    static_cast<can_fd_link_t *>(ctx)->handle_rx(data, len, timestamp);
+}
+
+void can_fd_link_t::handle_rx(const uint8_t *data, uint8_t len,
+                              uint32_t timestamp) // ISR
+{
+    if (len < HEADER_LEN || data[0] >= MAX_TYPE_NUM)
+    {
+        _stat.rx_invalid++;
+        return;
+    }
+    rx_slot_t &slot = _rx_slot[data[0]];
+    if (0 != slot.lock)
+        _stat.rx_lost += static_cast<uint8_t>(data[1] - slot.seq - 1U);
+
+    slot.lock = slot.lock + 1;
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+    slot.len       = len - HEADER_LEN;
+    slot.seq       = data[1];
+    slot.timestamp = timestamp;
+    memcpy(slot.payload.data(), data + HEADER_LEN, len - HEADER_LEN);
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+    slot.lock = slot.lock + 1;
+    _stat.rx_frames++;
+}
+}; // namespace pyro
@@ -0,0 +1,93 @@
+#ifndef CAN_FD_LINK_H
+#define CAN_FD_LINK_H
+
+#include "pyro_can_drv.h"
+
+#include <array>
+#include <type_traits>
+
+namespace pyro
+{
+/**
+ * @brief Typed board-to-board packets over one CAN-FD bus.
+ *
+ * Frame layout: [0] message type, [1] per-type sequence number, [2..]
+ * payload, zero padded to the next FD length. One 64-byte frame carries up
+ * to MAX_PAYLOAD bytes, e.g. a full IMU + gimbal + chassis state per tick.
+ * Each type keeps the latest packet behind a sequence lock (single ISR
+ * writer), so read() never returns a torn struct.
+ */
+class can_fd_link_t
+{
+  public:
+    static constexpr uint8_t HEADER_LEN   = 2;
+    static constexpr uint8_t MAX_PAYLOAD  = can_drv_t::FD_MAX_DATA_LEN - 2;
+    static constexpr uint8_t MAX_TYPE_NUM = 8;
+
+    struct link_stat_t
+    {
+        volatile uint32_t tx_frames;
+        volatile uint32_t tx_dropped; // HW TX FIFO full
+        volatile uint32_t rx_frames;
+        volatile uint32_t rx_lost;    // Sequence gaps
+        volatile uint32_t rx_invalid; // Unknown type or short frame
+    };
+
+    struct rx_info_t
+    {
+        uint8_t seq;        // Sequence number of the packet read
+        uint32_t timestamp; // DWT CYCCNT at SOF
+        bool fresh;         // New since the previous read of this type
+    };
+
+    can_fd_link_t(can_drv_t *can, uint32_t tx_id, uint32_t rx_id);
+    ~can_fd_link_t();
+
+    status_t init();
+
+    template <typename T> status_t send(uint8_t type, const T &msg)
+    {
+        static_assert(std::is_trivially_copyable<T>::value,
+                      "packets are copied bytewise");
+        static_assert(sizeof(T) <= MAX_PAYLOAD, "packet exceeds one frame");
+        return send_raw(type, &msg, sizeof(T));
+    }
+
+    template <typename T>
+    bool read(uint8_t type, T &msg, rx_info_t *info = nullptr)
+    {
+        static_assert(std::is_trivially_copyable<T>::value,
+                      "packets are copied bytewise");
+        static_assert(sizeof(T) <= MAX_PAYLOAD, "packet exceeds one frame");
+        return read_raw(type, &msg, sizeof(T), info);
+    }
+
+    status_t send_raw(uint8_t type, const void *payload, uint8_t len);
+    bool read_raw(uint8_t type, void *payload, uint8_t len, rx_info_t *info);
+    const link_stat_t &get_stat() const;
+
+  private:
+    struct rx_slot_t
+    {
+        volatile uint32_t lock; // Odd while the ISR is writing
+        uint8_t len;
+        uint8_t seq;
+        uint32_t timestamp;
+        uint32_t read_lock;     // lock value seen by the last read
+        std::array<uint8_t, MAX_PAYLOAD> payload;
+    };
+
+    static void rx_handler(void *ctx, uint32_t id, const uint8_t *data,
+                           uint8_t len, uint32_t timestamp);
+    void handle_rx(const uint8_t *data, uint8_t len, uint32_t timestamp);
+
+    can_drv_t *_can;
+    uint32_t _tx_id;
+    uint32_t _rx_id;
+    std::array<uint8_t, MAX_TYPE_NUM> _tx_seq{};
+    std::array<rx_slot_t, MAX_TYPE_NUM> _rx_slot{};
+    link_stat_t _stat{};
+};
+}; // namespace pyro
+
+#endif
@@ -6,8 +6,8 @@
  *
  * @author Wang Hongxi (Original C)
  * @author Lucky (C++ Refactor)
- * @version 1.1.0
- * @date 2025-11-13
+ * @version 1.2.0
+ * @date 2026-10-17
  */
 
 /* Includes ------------------------------------------------------------------*/
@@ -34,11 +34,13 @@ void dwt_drv_t::init(const uint32_t cpu_freq_mhz)
     _cpu_freq_hz    = cpu_freq_mhz * 1000000;
     _cpu_freq_hz_ms = _cpu_freq_hz / 1000;
     _cpu_freq_hz_us = _cpu_freq_hz / 1000000;
+    _inv_freq_hz    = 1.0f / static_cast<float>(_cpu_freq_hz);
+    _inv_freq_hz_ms = 1.0f / static_cast<float>(_cpu_freq_hz_ms);
+    _div_s          = make_divisor(_cpu_freq_hz);
+    _div_us         = make_divisor(_cpu_freq_hz_us);
 
-    // Reset all counter states
-    _cyccnt_round_count = 0;
-    _cyccnt_last        = 0;
-    _cyccnt_64          = 0;
+    // Reset the wrap state
+    _wrap_state.store(0, std::memory_order_relaxed);
 }
 
 /**
@@ -70,28 +72,77 @@ double dwt_drv_t::get_delta_t_64(uint32_t *cnt_last)
     return dt;
 }
 
+dwt_drv_t::divisor_t dwt_drv_t::make_divisor(const uint32_t d)
+{
+    return {d, UINT64_MAX / d};
+}
+
 /**
- * @brief Updates the internal _sys_time structure.
+ * @brief n / d via the high half of n * m, then one correction step.
+ *
+ * m = floor((2^64 - 1) / d) undershoots 2^64 / d by less than 1, so the
+ * estimate is at most one below the true quotient. Costs four 32x32
+ * multiplies instead of a call to the 64-bit division helper.
  */
-void dwt_drv_t::update_sys_time()
+uint64_t dwt_drv_t::divide(const uint64_t n, const divisor_t &div)
 {
-    // Must update overflow counter first
-    update_cycle_count();
+    const uint64_t n_lo = static_cast<uint32_t>(n);
+    const uint64_t n_hi = n >> 32;
+    const uint64_t m_lo = static_cast<uint32_t>(div.m);
+    const uint64_t m_hi = div.m >> 32;
+
+    const uint64_t lo_lo = n_lo * m_lo;
+    const uint64_t lo_hi = n_lo * m_hi;
+    const uint64_t hi_lo = n_hi * m_lo;
+    const uint64_t mid   = (lo_lo >> 32) + static_cast<uint32_t>(lo_hi) +
+                         static_cast<uint32_t>(hi_lo);
+    uint64_t q = n_hi * m_hi + (lo_hi >> 32) + (hi_lo >> 32) + (mid >> 32);
+
+    if (n - q * div.d >= div.d)
+    {
+        q++;
+    }
+    return q;
+}
 
-    const volatile uint32_t cnt_now = DWT->CYCCNT;
+/**
+ * @brief Gets the monotonic 64-bit cycle count.
+ *
+ * The state is loaded before CYCCNT is sampled, so a reader preempted in
+ * between still pairs an older state with a newer count, which the top-byte
+ * comparison handles. The new state is published only when the top byte
+ * moved, i.e. once every 2^24 cycles.
+ */
+uint64_t dwt_drv_t::get_cycles()
+{
+    const uint32_t state   = _wrap_state.load(std::memory_order_acquire);
+    const uint32_t cnt_now = DWT->CYCCNT;
+    const uint32_t top     = cnt_now >> 24;
+    uint32_t wraps         = state >> 8;
+    if (top < (state & 0xFFU))
+    {
+        wraps++; // CYCCNT wrapped since the state was stored
+    }
+
+    const uint32_t fresh = (wraps << 8) | top;
+    if (fresh != state)
+    {
+        // A failed CAS means a concurrent reader already published a newer
+        // state, the value computed here is still correct.
+        uint32_t expected = state;
+        _wrap_state.compare_exchange_strong(expected, fresh,
+                                            std::memory_order_release,
+                                            std::memory_order_relaxed);
+    }
+    return (static_cast<uint64_t>(wraps) << 32) | cnt_now;
+}
 
-    // Calculate 64-bit total cycle count
-    _cyccnt_64 = static_cast<uint64_t>(_cyccnt_round_count) * 0x100000000ULL +
-                 static_cast<uint64_t>(cnt_now);
-
-    // Decompose into s, ms, us
-    const uint64_t cnt_temp_1 = _cyccnt_64 / _cpu_freq_hz;
-    const uint64_t cnt_temp_2 = _cyccnt_64 - cnt_temp_1 * _cpu_freq_hz;
-    _sys_time.s               = static_cast<uint32_t>(cnt_temp_1);
-    _sys_time.ms = static_cast<uint16_t>(cnt_temp_2 / _cpu_freq_hz_ms);
-    const uint64_t cnt_temp_3 =
-        cnt_temp_2 - static_cast<uint64_t>(_sys_time.ms) * _cpu_freq_hz_ms;
-    _sys_time.us = static_cast<uint16_t>(cnt_temp_3 / _cpu_freq_hz_us);
+/**
+ * @brief Refreshes the wrap state.
+ */
+void dwt_drv_t::refresh()
+{
+    get_cycles();
 }
 
 /**
@@ -99,10 +150,10 @@ void dwt_drv_t::update_sys_time()
  */
 float dwt_drv_t::get_timeline_s()
 {
-    update_sys_time();
-    return static_cast<float>(_sys_time.s) +
-           static_cast<float>(_sys_time.ms) * 0.001f +
-           static_cast<float>(_sys_time.us) * 0.000001f;
+    const uint64_t cycles = get_cycles();
+    const uint64_t s      = divide(cycles, _div_s);
+    const auto rem = static_cast<uint32_t>(cycles - s * _cpu_freq_hz);
+    return static_cast<float>(s) + static_cast<float>(rem) * _inv_freq_hz;
 }
 
 /**
@@ -110,10 +161,11 @@ float dwt_drv_t::get_timeline_s()
  */
 float dwt_drv_t::get_timeline_ms()
 {
-    update_sys_time();
-    return static_cast<float>(_sys_time.s) * 1000.0f +
-           static_cast<float>(_sys_time.ms) +
-           static_cast<float>(_sys_time.us) * 0.001f;
+    const uint64_t cycles = get_cycles();
+    const uint64_t s      = divide(cycles, _div_s);
+    const auto rem = static_cast<uint32_t>(cycles - s * _cpu_freq_hz);
+    return static_cast<float>(s) * 1000.0f +
+           static_cast<float>(rem) * _inv_freq_hz_ms;
 }
 
 /**
@@ -121,10 +173,7 @@ float dwt_drv_t::get_timeline_ms()
  */
 uint64_t dwt_drv_t::get_timeline_us()
 {
-    update_sys_time();
-    return static_cast<uint64_t>(_sys_time.s) * 1000000 +
-           static_cast<uint64_t>(_sys_time.ms) * 1000 +
-           static_cast<uint64_t>(_sys_time.us);
+    return divide(get_cycles(), _div_us);
 }
 
 /**
@@ -132,21 +181,16 @@ uint64_t dwt_drv_t::get_timeline_us()
  */
 dwt_drv_t::time_t dwt_drv_t::get_timeline()
 {
-    update_sys_time();
-    return _sys_time;
-}
-
-/**
- * @brief Updates the 32-bit counter overflow.
- */
-void dwt_drv_t::update_cycle_count()
-{
-    const volatile uint32_t cnt_now = DWT->CYCCNT;
-    if (cnt_now < _cyccnt_last)
-    {
-        _cyccnt_round_count++;
-    }
-    _cyccnt_last = cnt_now;
+    const uint64_t cycles = get_cycles();
+    const uint64_t s      = divide(cycles, _div_s);
+    const auto rem = static_cast<uint32_t>(cycles - s * _cpu_freq_hz);
+
+    time_t time;
+    time.s  = static_cast<uint32_t>(s);
+    time.ms = static_cast<uint16_t>(rem / _cpu_freq_hz_ms);
+    time.us = static_cast<uint16_t>((rem - time.ms * _cpu_freq_hz_ms) /
+                                    _cpu_freq_hz_us);
+    return time;
 }
 
 /**
@@ -187,4 +231,12 @@ uint32_t dwt_drv_t::get_current_ticks()
     return DWT->CYCCNT;
 }
 
-} // namespace pyro
\ No newline at end of file
+} // namespace pyro
+
+/**
+ * @brief FreeRTOS tick hook, keeps the 64-bit timeline wrap state fresh.
+ */
+extern "C" void vApplicationTickHook(void)
+{
+    pyro::dwt_drv_t::refresh();
+}
@@ -7,8 +7,8 @@
  *
  * @author Wang Hongxi (Original C)
  * @author Lucky (C++ Refactor)
- * @version 1.1.0
- * @date 2025-11-13
+ * @version 1.2.0
+ * @date 2026-10-17
  */
 
 #ifndef __PYRO_DWT_DRV_H__
@@ -16,14 +16,28 @@
 
 #include "stdint.h"
 
+#include <atomic>
+
 namespace pyro
 {
+namespace host_test
+{
+struct dwt_probe_t; // Host test access to divide()
+} // namespace host_test
 
 /**
  * @brief C++ DWT (Data Watchpoint and Trace) high-resolution timer driver.
  *
  * This is a static class providing a singleton interface to the
  * ARM Cortex-M DWT CYCCNT register for high-precision timing.
+ *
+ * The 64-bit timeline extends CYCCNT with a single 32-bit state word:
+ * [31:8] wrap count, [7:0] top byte of the last CYCCNT seen. A reader that
+ * finds a smaller top byte than the stored one knows CYCCNT wrapped and
+ * publishes the new state with a CAS, so get_cycles() is reentrant from any
+ * task or ISR without locks. The state must be refreshed at least once per
+ * 255/256 of a wrap period (8.9 s at 480 MHz); the FreeRTOS tick hook calls
+ * refresh() every tick. The count covers 2^56 cycles (4.7 years at 480 MHz).
  */
 class dwt_drv_t
 {
@@ -86,6 +100,16 @@ class dwt_drv_t
      */
     static time_t get_timeline();
 
+    /**
+     * @brief Gets the monotonic 64-bit cycle count since init(), any context.
+     */
+    static uint64_t get_cycles();
+
+    /**
+     * @brief Keeps the wrap state fresh. Cheap, called from the tick hook.
+     */
+    static void refresh();
+
     /**
      * @brief Blocking delay (float, seconds).
      */
@@ -102,24 +126,29 @@ class dwt_drv_t
     static uint32_t get_current_ticks();
 
   private:
-    /**
-     * @brief Updates the 64-bit cycle counter to handle 32-bit overflow.
-     */
-    static void update_cycle_count();
+    friend struct host_test::dwt_probe_t;
 
     /**
-     * @brief Updates the internal _sys_time structure.
+     * @brief Reciprocal for an exact 64-by-32 division by multiply-shift.
      */
-    static void update_sys_time();
+    struct divisor_t
+    {
+        uint32_t d;
+        uint64_t m; // floor((2^64 - 1) / d)
+    };
+
+    static divisor_t make_divisor(uint32_t d);
+    static uint64_t divide(uint64_t n, const divisor_t &div);
 
     // --- Private Static Members (replaces C globals) ---
     inline static uint32_t _cpu_freq_hz{};
     inline static uint32_t _cpu_freq_hz_ms{};
     inline static uint32_t _cpu_freq_hz_us{};
-    inline static uint32_t _cyccnt_round_count{}; // 32-bit counter overflow count
-    inline static uint32_t _cyccnt_last{}; // Last count, for overflow detection
-    inline static uint64_t _cyccnt_64{};   // 64-bit total cycle count
-    inline static time_t _sys_time{};      // Formatted system time
+    inline static float _inv_freq_hz{};
+    inline static float _inv_freq_hz_ms{};
+    inline static divisor_t _div_s{};
+    inline static divisor_t _div_us{};
+    inline static std::atomic<uint32_t> _wrap_state{}; // See class comment
 };
 
 } // namespace pyro
@@ -17,94 +17,242 @@
 #include "stm32h7xx_hal_dma.h"
 
 #include <cstring>
-#include <map>
+#include <type_traits>
 
 #include "pyro_core_dma_heap.h"
+#include "pyro_dwt_drv.h"
 #include "pyro_uart_drv.h"
+#include "task.h"
 #include "usart.h"
 
-#include <stdexcept>
-
 namespace pyro
 {
+/* Default Configuration -----------------------------------------------------*/
+/**
+ * @brief Buffer configuration used when config() was not called.
+ */
+static const uart_drv_t::uart_desc_t default_desc_table[] = {
+    {&huart1, uart_default_buf_cfg[uart_drv_t::uart1], nullptr, nullptr},
+    {&huart5, uart_default_buf_cfg[uart_drv_t::uart5], nullptr, nullptr},
+    {&huart7, uart_default_buf_cfg[uart_drv_t::uart7], nullptr, nullptr},
+    {&huart10, uart_default_buf_cfg[uart_drv_t::uart10], nullptr, nullptr},
+};
+static_assert(sizeof(uart_default_buf_cfg) / sizeof(uart_buf_cfg_t) ==
+                  sizeof(default_desc_table) / sizeof(uart_drv_t::uart_desc_t),
+              "one default buffer configuration per board UART");
+
+/**
+ * @brief Every U(S)ART of the STM32H723, for the slot uniqueness check.
+ */
+static constexpr uintptr_t uart_base_list[] = {
+    USART1_BASE, USART2_BASE, USART3_BASE, UART4_BASE,
+    UART5_BASE,  USART6_BASE, UART7_BASE,  UART8_BASE,
+    UART9_BASE,  USART10_BASE, LPUART1_BASE};
+
+static constexpr bool instance_slots_unique()
+{
+    for (const uintptr_t a : uart_base_list)
+    {
+        uint8_t same = 0;
+        for (const uintptr_t b : uart_base_list)
+        {
+            if (uart_drv_t::instance_slot(a) == uart_drv_t::instance_slot(b))
+            {
+                same++;
+            }
+        }
+        if (same != 1)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+static_assert(instance_slots_unique(), "two U(S)ARTs share a lookup slot");
+
 /* Constructor and Destructor ------------------------------------------------*/
 /**
  * @brief Constructor for the UART driver.
  *
- * Allocates two DMA-capable buffers, registers the instance in the static map,
- * and initializes state flags.
+ * Allocates all buffers of the descriptor as one block (see
+ * plan_uart_layout()) and initializes state flags. A tx_ring_size of 0 (or
+ * one that is not a power of two) disables the TX queue: write() then hands
+ * the caller's buffer to the DMA directly. Instances are created by
+ * get_instance().
  */
-uart_drv_t::uart_drv_t(UART_HandleTypeDef *huart, const uint16_t buf_length)
-    : rx_buf{nullptr, nullptr}, _huart(huart)
+uart_drv_t::uart_drv_t(const uart_desc_t &desc)
+    : rx_buf{nullptr, nullptr}, _huart(desc.huart),
+      _mem_free(desc.mem_alloc ? desc.mem_free : vPortDmaFree)
 {
-    uart_map()[huart] = this;
-    rx_buf[0]         = static_cast<uint8_t *>(pvPortDmaMalloc(buf_length));
-    rx_buf[1]         = static_cast<uint8_t *>(pvPortDmaMalloc(buf_length));
-    if (rx_buf[0] && rx_buf[1])
+    const uart_buf_layout_t layout = plan_uart_layout(desc.buf);
+    if (0 == layout.size)
     {
-        state.init_flag = true;
-        memset(rx_buf[0], 0, buf_length);
-        memset(rx_buf[1], 0, buf_length);
-        _rx_buf_size = buf_length;
+        return;
     }
+    _mem_raw = static_cast<uint8_t *>(
+        (desc.mem_alloc ? desc.mem_alloc : pvPortDmaMalloc)(layout.alloc_size));
+    if (nullptr == _mem_raw)
+    {
+        return;
+    }
+    uint8_t *mem = reinterpret_cast<uint8_t *>(
+        (reinterpret_cast<uintptr_t>(_mem_raw) + UART_CACHE_LINE - 1) &
+        ~static_cast<uintptr_t>(UART_CACHE_LINE - 1));
+    memset(mem, 0, layout.size);
+
+    rx_buf[0]     = mem + layout.rx_buf[0];
+    rx_buf[1]     = mem + layout.rx_buf[1];
+    _rx_buf_size  = desc.buf.rx_buf_size;
     rx_buf_switch = 0;
+    if (desc.buf.rx_ring_size)
+    {
+        _rx_ring      = mem + layout.rx_ring;
+        _rx_ring_size = desc.buf.rx_ring_size;
+    }
+    if (layout.size > layout.tx_ring)
+    {
+        _tx_ring      = mem + layout.tx_ring;
+        _tx_ring_size = desc.buf.tx_ring_size;
+    }
+    state.init_flag = true;
 }
 
 /**
  * @brief Destructor.
  *
- * Frees DMA-allocated buffers and removes the instance from the static map.
+ * Frees the buffer block and removes the instance from the static instance
+ * table.
  */
 uart_drv_t::~uart_drv_t()
 {
-    if (rx_buf[0])
+    for (auto &drv : _instances)
+    {
+        if (this == drv)
+        {
+            drv = nullptr;
+        }
+    }
+    for (auto &drv : _slot_map)
     {
-        vPortFree(rx_buf[0]);
-        rx_buf[0] = nullptr;
+        if (this == drv)
+        {
+            drv = nullptr;
+        }
     }
-    if (rx_buf[1])
+    if (_mem_raw && _mem_free)
     {
-        vPortFree(rx_buf[1]);
-        rx_buf[1] = nullptr;
+        _mem_free(_mem_raw);
     }
-    uart_map().erase(_huart);
+    _mem_raw = nullptr;
 }
 
+/* Static Instance Table -----------------------------------------------------*/
 /**
- * @brief Accessor for the UART driver Singleton instance.
+ * @brief Replaces the descriptor table, one entry per UART.
  *
- * This function uses the "Magic Static" (Meyers' Singleton) pattern
- * to create and return a driver instance for a specific UART peripheral.
+ * Must run before the first get_instance() of the listed UARTs, e.g. at the
+ * top of the init thread; returns PYRO_BUSY once any instance exists.
+ */
+status_t uart_drv_t::config(const uart_desc_t *table, const uint8_t num)
+{
+    if (nullptr == table || 0 == num || num > MAX_UART_NUM)
+    {
+        return PYRO_PARAM_ERROR;
+    }
+    status_t status = PYRO_OK;
+    vTaskSuspendAll();
+    for (const auto drv : _instances)
+    {
+        if (drv)
+        {
+            status = PYRO_BUSY;
+        }
+    }
+    if (PYRO_OK == status)
+    {
+        for (uint8_t i = 0; i < num; i++)
+        {
+            _desc_table[i] = table[i];
+        }
+        _desc_num = num;
+    }
+    xTaskResumeAll();
+    return status;
+}
+
+/**
+ * @brief Accessor for the UART driver instance of a board UART.
  */
 uart_drv_t *uart_drv_t::get_instance(const which_uart uart)
 {
     switch (uart)
     {
         case uart1:
-            static uart_drv_t uart_drv1(&huart1, 42);
-            return &uart_drv1;
+            return get_instance(&huart1);
         case uart5:
-            static uart_drv_t uart_drv5(&huart5, 36);
-            return &uart_drv5;
+            return get_instance(&huart5);
         case uart7:
-            static uart_drv_t uart_drv7(&huart7, 48);
-            return &uart_drv7;
+            return get_instance(&huart7);
         case uart10:
-            static uart_drv_t uart_drv10(&huart10, 64);
-            return &uart_drv10;
+            return get_instance(&huart10);
         default:
             return nullptr;
     }
 }
-/* Static Map Management -----------------------------------------------------*/
+
+/**
+ * @brief Returns the driver of a HAL handle, creating it from its descriptor
+ * on first use. nullptr if the UART has no descriptor or its buffers could
+ * not be allocated. The handle must be initialised (Instance set), which is
+ * where the HAL callbacks find the driver.
+ */
+uart_drv_t *uart_drv_t::get_instance(UART_HandleTypeDef *huart)
+{
+    uart_drv_t *drv = nullptr;
+    vTaskSuspendAll();
+    if (0 == _desc_num)
+    {
+        for (const auto &desc : default_desc_table)
+        {
+            _desc_table[_desc_num++] = desc;
+        }
+    }
+    for (uint8_t i = 0; i < _desc_num; i++)
+    {
+        if (huart != _desc_table[i].huart)
+        {
+            continue;
+        }
+        if (nullptr == _instances[i])
+        {
+            auto *created = new uart_drv_t(_desc_table[i]);
+            if (created->state.init_flag)
+            {
+                _instances[i] = created;
+                _slot_map[instance_slot(
+                    reinterpret_cast<uintptr_t>(huart->Instance))] = created;
+            }
+            else
+            {
+                delete created;
+            }
+        }
+        drv = _instances[i];
+        break;
+    }
+    xTaskResumeAll();
+    return drv;
+}
+
 /**
- * @brief Provides access to the static map linking HAL handles to driver
- * instances.
+ * @brief Looks up the driver of a HAL handle. One table load, no allocation,
+ * safe to call from the HAL callbacks.
  */
-std::map<UART_HandleTypeDef *, uart_drv_t *> &uart_drv_t::uart_map()
+uart_drv_t *uart_drv_t::from_handle(const UART_HandleTypeDef *huart)
 {
-    static std::map<UART_HandleTypeDef *, uart_drv_t *> instance;
-    return instance;
+    uart_drv_t *drv = _slot_map[instance_slot(
+        reinterpret_cast<uintptr_t>(huart->Instance))];
+    return (drv && huart == drv->_huart) ? drv : nullptr;
 }
 
 /* Transmission Methods ------------------------------------------------------*/
@@ -135,20 +283,271 @@ status_t uart_drv_t::write(const uint8_t *p, const uint16_t size,
 
 /**
  * @brief Non-blocking write using HAL DMA. Updates state flags on busy status.
+ *
+ * With a TX queue the data is copied into the TX ring, so the caller may
+ * reuse its buffer at once, and the write is sent after the ones queued
+ * before it. Any task or ISR may call this concurrently: space is reserved
+ * with a single compare-and-swap and the TX-complete interrupt chains the
+ * queued writes into as few DMA bursts as possible. PYRO_BUSY means the
+ * ring or the descriptor table is full and nothing was queued.
  */
 status_t uart_drv_t::write(const uint8_t *p, const uint16_t size)
 {
-    const uint8_t ret = HAL_UART_Transmit_DMA(_huart, p, size);
-    if (ret == HAL_OK)
+    if (nullptr == _tx_ring)
+    {
+        const uint8_t ret = HAL_UART_Transmit_DMA(_huart, p, size);
+        if (ret == HAL_OK)
+        {
+            return PYRO_OK;
+        }
+        if (ret == HAL_BUSY)
+        {
+            state.tx_busy = 0x01U;
+            return PYRO_BUSY;
+        }
+        return PYRO_ERROR;
+    }
+    if (0 == size)
     {
         return PYRO_OK;
     }
-    if (ret == HAL_BUSY)
+    if (size > _tx_ring_size)
+    {
+        return PYRO_PARAM_ERROR;
+    }
+
+    uint32_t head, next;
+    uint16_t pos, seq, used, queued;
+    do
+    {
+        const uint16_t byte_tail = _tx_byte_tail;
+        const uint16_t desc_tail = _tx_desc_tail;
+        head   = _tx_head.load(); // After the tails, so it never lags them
+        seq    = static_cast<uint16_t>(head >> 16);
+        pos    = static_cast<uint16_t>(head);
+        used   = static_cast<uint16_t>(pos - byte_tail);
+        queued = static_cast<uint16_t>(seq - desc_tail);
+        if (used + size > _tx_ring_size || queued >= TX_DESC_NUM)
+        {
+            _tx_stat.tx_dropped++;
+            state.tx_busy = 0x01U;
+            return PYRO_BUSY;
+        }
+        next = static_cast<uint32_t>(static_cast<uint16_t>(seq + 1)) << 16 |
+               static_cast<uint16_t>(pos + size);
+    } while (!_tx_head.compare_exchange_weak(head, next));
+
+    const uint16_t offset = pos & (_tx_ring_size - 1);
+    const uint16_t first  = size < _tx_ring_size - offset
+                                ? size
+                                : static_cast<uint16_t>(_tx_ring_size - offset);
+    memcpy(_tx_ring + offset, p, first);
+    memcpy(_tx_ring, p + first, size - first);
+
+    tx_desc_t &desc = _tx_desc[seq & (TX_DESC_NUM - 1)];
+    desc.pos        = pos;
+    desc.len        = size;
+    std::atomic_thread_fence(std::memory_order_release);
+    desc.ready = 1;
+
+    if (used + size > _tx_stat.high_water)
+    {
+        _tx_stat.high_water = used + size;
+    }
+    if (queued + 1 > _tx_stat.desc_high_water)
+    {
+        _tx_stat.desc_high_water = queued + 1;
+    }
+    pump_tx();
+    return PYRO_OK;
+}
+
+/**
+ * @brief Sequence number of the next write. tx_done() turns true once every
+ * write queued before this call has left the ring.
+ */
+uint16_t uart_drv_t::tx_fence() const
+{
+    return static_cast<uint16_t>(_tx_head.load() >> 16);
+}
+
+bool uart_drv_t::tx_done(const uint16_t fence) const
+{
+    return static_cast<int16_t>(_tx_desc_tail - fence) >= 0;
+}
+
+/**
+ * @brief Blocks the calling task until all writes queued so far are sent.
+ */
+status_t uart_drv_t::flush(const uint32_t timeout_ms)
+{
+    if (nullptr == _tx_ring)
+    {
+        return PYRO_OK;
+    }
+    const uint16_t fence   = tx_fence();
+    const TickType_t start = xTaskGetTickCount();
+    while (!tx_done(fence))
     {
+        if (xTaskGetTickCount() - start >= pdMS_TO_TICKS(timeout_ms))
+        {
+            return PYRO_TIMEOUT;
+        }
+        pump_tx(); // Retry if the UART was busy with a polling write
+        vTaskDelay(1);
+    }
+    return PYRO_OK;
+}
+
+status_t uart_drv_t::get_tx_stat(tx_stat_t &stat)
+{
+    const uint32_t tx_bytes = _tx_stat.tx_bytes;
+    const float dt          = dwt_drv_t::get_delta_t(&_tx_stat_cnt_last);
+
+    stat.tx_bytes        = tx_bytes;
+    stat.tx_writes       = _tx_stat.tx_writes;
+    stat.tx_bursts       = _tx_stat.tx_bursts;
+    stat.tx_dropped      = _tx_stat.tx_dropped;
+    stat.tx_errors       = _tx_stat.tx_errors;
+    stat.high_water      = _tx_stat.high_water;
+    stat.desc_high_water = _tx_stat.desc_high_water;
+    stat.tx_bps = dt > 0.0f ? (tx_bytes - _tx_stat_bytes_last) / dt : 0.0f;
+
+    _tx_stat_bytes_last = tx_bytes;
+    return PYRO_OK;
+}
+
+/**
+ * @brief Starts a burst unless one is running. Whoever sets _tx_active owns
+ * the DMA until the TX-complete interrupt hands it back.
+ */
+void uart_drv_t::pump_tx()
+{
+    do
+    {
+        if (_tx_active.exchange(true))
+        {
+            return;
+        }
+        if (start_tx())
+        {
+            return;
+        }
+        _tx_active.store(false);
+        // A write may have become ready after start_tx() looked
+    } while (_tx_desc[_tx_desc_tail & (TX_DESC_NUM - 1)].ready &&
+             HAL_UART_STATE_READY == _huart->gState);
+}
+
+/**
+ * @brief Sends every ready write from the tail in one burst, stopping at the
+ * first write still being copied and at the end of the ring (owner only).
+ */
+bool uart_drv_t::start_tx()
+{
+    const uint16_t seq_head = static_cast<uint16_t>(_tx_head.load() >> 16);
+    const uint16_t tail     = _tx_byte_tail;
+    uint16_t end            = tail;
+    for (uint16_t seq = _tx_desc_tail; seq != seq_head; seq++)
+    {
+        const tx_desc_t &desc = _tx_desc[seq & (TX_DESC_NUM - 1)];
+        if (!desc.ready)
+        {
+            break;
+        }
+        end = desc.pos + desc.len;
+    }
+
+    const uint16_t offset = tail & (_tx_ring_size - 1);
+    uint16_t len          = end - tail;
+    if (len > _tx_ring_size - offset)
+    {
+        len = _tx_ring_size - offset; // Rest follows from the ring start
+    }
+    if (0 == len)
+    {
+        return false;
+    }
+
+    // Masked so that no UART or DMA interrupt sees the burst half started;
+    // _tx_inflight is only published once HAL has taken the transfer
+    std::atomic_thread_fence(std::memory_order_acquire);
+    UBaseType_t irq_state = taskENTER_CRITICAL_FROM_ISR();
+    if (HAL_OK != HAL_UART_Transmit_DMA(_huart, _tx_ring + offset, len))
+    {
+        taskEXIT_CRITICAL_FROM_ISR(irq_state);
         state.tx_busy = 0x01U;
-        return PYRO_BUSY;
+        return false;
     }
-    return PYRO_ERROR;
+    _tx_inflight = len;
+    taskEXIT_CRITICAL_FROM_ISR(irq_state);
+    _tx_stat.tx_bursts++;
+    return true;
+}
+
+/**
+ * @brief Advances the tail past the sent bytes and releases the writes that
+ * are now complete.
+ */
+void uart_drv_t::retire_tx(const uint16_t sent)
+{
+    _tx_byte_tail           = _tx_byte_tail + sent;
+    const uint16_t seq_head = static_cast<uint16_t>(_tx_head.load() >> 16);
+    uint16_t seq            = _tx_desc_tail;
+    while (seq != seq_head)
+    {
+        tx_desc_t &desc = _tx_desc[seq & (TX_DESC_NUM - 1)];
+        if (!desc.ready ||
+            static_cast<int16_t>(desc.pos + desc.len - _tx_byte_tail) > 0)
+        {
+            break;
+        }
+        desc.ready = 0;
+        seq++;
+        _tx_stat.tx_writes++;
+    }
+    _tx_desc_tail = seq;
+}
+
+void uart_drv_t::handle_tx_complete()
+{
+    if (nullptr == _tx_ring || 0 == _tx_inflight)
+    {
+        return;
+    }
+    _tx_stat.tx_bytes += _tx_inflight;
+    retire_tx(_tx_inflight);
+    _tx_inflight = 0;
+    if (start_tx())
+    {
+        return;
+    }
+    _tx_active.store(false);
+    pump_tx();
+}
+
+/**
+ * @brief The aborted burst is dropped, not resent: part of it may already
+ * have gone out and the receiver resynchronises on the next packet.
+ *
+ * Only a TX DMA error aborts the burst. RX errors (ORE/FE/NE/PE) reach the
+ * same HAL callback while the TX DMA keeps running, so they must not touch
+ * the queue.
+ */
+void uart_drv_t::handle_tx_error()
+{
+    if (nullptr == _tx_ring || 0 == _tx_inflight ||
+        0 == (_huart->ErrorCode & HAL_UART_ERROR_DMA) ||
+        nullptr == _huart->hdmatx ||
+        HAL_DMA_ERROR_NONE == _huart->hdmatx->ErrorCode)
+    {
+        return;
+    }
+    _tx_stat.tx_errors++;
+    retire_tx(_tx_inflight);
+    _tx_inflight = 0;
+    _tx_active.store(false);
+    pump_tx();
 }
 
 /* Reception Control Methods -------------------------------------------------*/
@@ -165,6 +564,11 @@ status_t uart_drv_t::enable_rx_dma()
     {
         return PYRO_ERROR;
     }
+    if (state.rx_circular)
+    {
+        // Error recovery and reset() re-arm the ring instead
+        return start_rx_circular();
+    }
     const uint8_t ret = HAL_UARTEx_ReceiveToIdle_DMA(
         _huart, rx_buf[rx_buf_switch], _rx_buf_size);
     if (ret != HAL_OK)
@@ -199,6 +603,364 @@ status_t uart_drv_t::disable_rx_dma() const
     return PYRO_OK;
 }
 
+/**
+ * @brief Switches reception to circular DMA into the ring buffer.
+ *
+ * The ring comes from the descriptor (rx_ring_size) and the RX DMA stream is
+ * re-initialised in circular mode. HAL then reports the DMA write position on
+ * IDLE, half-transfer and transfer-complete events without ever stopping the
+ * stream, so there is no re-arm window in which bytes can be lost.
+ *
+ * Span callbacks receive every byte as it arrives. Callbacks added with
+ * add_rx_event_callback() still receive one contiguous frame per IDLE event;
+ * a frame that wraps the ring is copied to rx_buf[0] first, so it must fit
+ * into rx_buf_size.
+ */
+status_t uart_drv_t::enable_rx_circular()
+{
+    if (!state.init_flag || nullptr == _huart->hdmarx || nullptr == _rx_ring ||
+        _rx_ring_size < 2)
+    {
+        return PYRO_PARAM_ERROR;
+    }
+
+    HAL_UART_AbortReceive(_huart);
+    if (DMA_CIRCULAR != _huart->hdmarx->Init.Mode)
+    {
+        _huart->hdmarx->Init.Mode = DMA_CIRCULAR;
+        if (HAL_OK != HAL_DMA_Init(_huart->hdmarx))
+        {
+            return PYRO_ERROR;
+        }
+    }
+    state.rx_circular = 1;
+    return start_rx_circular();
+}
+
+/**
+ * @brief Starts the circular reception from the beginning of the ring.
+ *
+ * The half-transfer interrupt is kept enabled so a long burst is handed to
+ * the consumers every half ring instead of only at the next IDLE.
+ */
+status_t uart_drv_t::start_rx_circular()
+{
+    _rx_read_idx      = 0;
+    _rx_frame_idx     = 0;
+    _rx_frame_len     = 0;
+    _rx_frame_overrun = false;
+    _demux_idx        = 0;
+
+    const uint8_t ret =
+        HAL_UARTEx_ReceiveToIdle_DMA(_huart, _rx_ring, _rx_ring_size);
+    if (ret != HAL_OK)
+    {
+        state.rx_dma_enable = 0;
+        if (ret == HAL_BUSY)
+        {
+            state.rx_busy = 0x01U;
+        }
+        else
+        {
+            state.rx_error = 0x01U;
+        }
+        return PYRO_ERROR;
+    }
+    state.rx_dma_enable = 1;
+    state.rx_error      = 0;
+    state.rx_busy       = 0;
+    return PYRO_OK;
+}
+
+/**
+ * @brief Consumes the ring up to the DMA write position of an RX event.
+ *
+ * @param size Write position reported by HAL (ring size on TC, wraps to 0).
+ * @param type IDLE, HT or TC. HT/TC only advance the stream, IDLE also ends
+ * the frame that is handed to the legacy callbacks (UARTs without demux
+ * routes).
+ * @param woken Collects the callbacks' yield requests.
+ */
+void uart_drv_t::handle_rx_circular(const uint16_t size,
+                                    const HAL_UART_RxEventTypeTypeDef type,
+                                    BaseType_t *woken)
+{
+    const uint16_t pos =
+        size >= _rx_ring_size ? 0 : size; // Next byte the DMA will write
+    uint16_t pending =
+        (pos + _rx_ring_size - _rx_read_idx) % _rx_ring_size;
+
+    // HT/TC fire when their boundary is crossed, so an unchanged position
+    // means a whole ring arrived unseen. Otherwise the DMA has lapped us if it
+    // is now closer to the read index than the event position is.
+    const uint16_t live = static_cast<uint16_t>(
+        (_rx_ring_size - __HAL_DMA_GET_COUNTER(_huart->hdmarx)) %
+        _rx_ring_size);
+    const uint16_t live_pending =
+        (live + _rx_ring_size - _rx_read_idx) % _rx_ring_size;
+    bool overrun = live_pending < pending;
+    if (0 == pending && HAL_UART_RXEVENT_IDLE != type)
+    {
+        overrun = true;
+    }
+    if (overrun)
+    {
+        _link_stat.ring_overruns++;
+        _rx_frame_overrun = true;
+    }
+
+    if (overrun && _demux_idx != _rx_read_idx)
+    {
+        _demux_stat.dropped++; // Partial frame overwritten
+    }
+    if (overrun || 0 == _demux_route_num)
+    {
+        _demux_idx = pos;
+    }
+
+    if (pending)
+    {
+        rx_span_t span;
+        span.first     = _rx_ring + _rx_read_idx;
+        span.first_len = pending;
+        if (_rx_read_idx + pending > _rx_ring_size)
+        {
+            span.first_len = _rx_ring_size - _rx_read_idx;
+        }
+        span.second     = _rx_ring;
+        span.second_len = pending - span.first_len;
+        span.overrun    = overrun;
+        _link_stat.rx_bytes += pending;
+        for (auto &cb : _rx_span_callbacks)
+        {
+            if (cb.func.valid())
+            {
+                cb.func(span, woken);
+            }
+        }
+        _rx_read_idx = pos;
+        if (_rx_frame_len + pending >= _rx_ring_size)
+        {
+            // Frame no longer fits, its start has been overwritten
+            _rx_frame_len     = _rx_ring_size - 1;
+            _rx_frame_overrun = true;
+        }
+        else
+        {
+            _rx_frame_len += pending;
+        }
+    }
+
+    if (_demux_route_num)
+    {
+        const uint16_t avail =
+            (pos + _rx_ring_size - _demux_idx) % _rx_ring_size;
+        _demux_idx =
+            (_demux_idx + demux(_rx_ring, _rx_ring_size, _demux_idx, avail,
+                                woken)) %
+            _rx_ring_size;
+    }
+
+    if (HAL_UART_RXEVENT_IDLE == type && _rx_frame_len)
+    {
+        uint8_t *frame = _rx_ring + _rx_frame_idx;
+        if (_rx_frame_idx + _rx_frame_len > _rx_ring_size)
+        {
+            const uint16_t tail = _rx_ring_size - _rx_frame_idx;
+            frame = _rx_frame_len <= _rx_buf_size ? rx_buf[0] : nullptr;
+            if (frame)
+            {
+                memcpy(frame, _rx_ring + _rx_frame_idx, tail);
+                memcpy(frame + tail, _rx_ring, _rx_frame_len - tail);
+            }
+        }
+        if (frame && !_rx_frame_overrun && 0 == _demux_route_num)
+        {
+            dispatch_frame(frame, _rx_frame_len, woken);
+        }
+        _rx_frame_idx     = pos;
+        _rx_frame_len     = 0;
+        _rx_frame_overrun = false;
+    }
+}
+
+/**
+ * @brief Counts the error bits HAL latched in ErrorCode, clears all pending
+ * error flags (Parity, Framing, Overrun, etc.) and restarts DMA reception.
+ */
+void uart_drv_t::handle_error()
+{
+    const uint32_t error = _huart->ErrorCode;
+    if (error & HAL_UART_ERROR_PE)
+    {
+        _link_stat.parity_errors++;
+    }
+    if (error & HAL_UART_ERROR_NE)
+    {
+        _link_stat.noise_errors++;
+    }
+    if (error & HAL_UART_ERROR_FE)
+    {
+        _link_stat.framing_errors++;
+    }
+    if (error & HAL_UART_ERROR_ORE)
+    {
+        _link_stat.overrun_errors++;
+    }
+    if (error & HAL_UART_ERROR_DMA)
+    {
+        _link_stat.dma_errors++;
+    }
+
+    handle_tx_error();
+    __HAL_UART_CLEAR_FLAG(_huart, UART_CLEAR_PEF | UART_CLEAR_FEF |
+                                      UART_CLEAR_NEF | UART_CLEAR_OREF |
+                                      UART_CLEAR_RTOF);
+    _link_stat.dma_restarts++;
+    enable_rx_dma();
+}
+
+/**
+ * @brief RX event dispatch for both reception modes (ISR context).
+ *
+ * Double-buffer mode: demux routes get the frames found in the chunk, or, on
+ * a UART without routes, the first callback that consumes the data switches
+ * the RX buffer; DMA reception is then restarted. Circular mode: see
+ * handle_rx_circular(). The cost of every call, callbacks included, is
+ * recorded in cycles.
+ */
+void uart_drv_t::handle_rx_event(const uint16_t size)
+{
+    const uint32_t start = dwt_drv_t::get_current_ticks();
+    BaseType_t woken     = pdFALSE;
+    _rx_event_cnt        = start;
+    _link_stat.rx_events++;
+
+    if (state.rx_circular)
+    {
+        // Circular DMA keeps running, nothing to re-arm
+        handle_rx_circular(size, HAL_UARTEx_GetRxEventType(_huart), &woken);
+    }
+    else
+    {
+        _link_stat.rx_bytes += size;
+        if (_demux_route_num)
+        {
+            if (demux(rx_buf[rx_buf_switch], _rx_buf_size, 0, size, &woken) <
+                size)
+            {
+                _demux_stat.dropped++; // Frames split across chunks are lost
+            }
+        }
+        else if (dispatch_frame(rx_buf[rx_buf_switch], size, &woken))
+        {
+            rx_buf_switch ^= 0x01U;
+        }
+        _link_stat.dma_rearms++;
+        enable_rx_dma();
+    }
+
+    _rx_isr_hist.record(dwt_drv_t::get_current_ticks() - start);
+    portYIELD_FROM_ISR(woken);
+}
+
+const uart_drv_t::rx_isr_hist_t &uart_drv_t::get_rx_isr_hist() const
+{
+    return _rx_isr_hist;
+}
+
+uint32_t uart_drv_t::get_rx_event_ticks() const
+{
+    return _rx_event_cnt;
+}
+
+/**
+ * @brief Hands one received frame to the callbacks until one consumes it,
+ * counting acceptance per consumer.
+ * @return true if a callback consumed the frame.
+ */
+bool uart_drv_t::dispatch_frame(uint8_t *p, const uint16_t size,
+                                BaseType_t *woken)
+{
+    bool present = false;
+    for (auto &cb : _rx_event_callbacks)
+    {
+        if (!cb.func.valid())
+        {
+            continue;
+        }
+        present = true;
+        if (cb.func(p, size, woken))
+        {
+            cb.accepted++;
+            _link_stat.frames_delivered++;
+            return true;
+        }
+        cb.rejected++;
+    }
+    if (present)
+    {
+        _link_stat.frames_unclaimed++;
+    }
+    return false;
+}
+
+void uart_drv_t::get_link_stat(link_stat_t &stat) const
+{
+    stat.rx_bytes          = _link_stat.rx_bytes;
+    stat.rx_events         = _link_stat.rx_events;
+    stat.frames_delivered  = _link_stat.frames_delivered;
+    stat.frames_unclaimed  = _link_stat.frames_unclaimed;
+    stat.parity_errors     = _link_stat.parity_errors;
+    stat.noise_errors      = _link_stat.noise_errors;
+    stat.framing_errors    = _link_stat.framing_errors;
+    stat.overrun_errors    = _link_stat.overrun_errors;
+    stat.dma_errors        = _link_stat.dma_errors;
+    stat.ring_overruns     = _link_stat.ring_overruns;
+    stat.dma_restarts      = _link_stat.dma_restarts;
+    stat.dma_rearms        = _link_stat.dma_rearms;
+    stat.rx_isr_max_cycles = _rx_isr_hist.max();
+}
+
+uint8_t uart_drv_t::get_consumer_stat(consumer_stat_t *stat,
+                                      const uint8_t max_num) const
+{
+    uint8_t num = 0;
+    for (const auto &cb : _rx_event_callbacks)
+    {
+        if (cb.func.valid() && num < max_num)
+        {
+            stat[num++] = {cb.owner, cb.accepted, cb.rejected};
+        }
+    }
+    for (const auto &route : _demux_routes)
+    {
+        if (route.func.valid() && num < max_num)
+        {
+            stat[num++] = {route.owner, route.frames, 0};
+        }
+    }
+    return num;
+}
+
+void uart_drv_t::reset_link_stat()
+{
+    taskENTER_CRITICAL();
+    _link_stat  = link_stat_t{};
+    _demux_stat = demux_stat_t{};
+    for (auto &cb : _rx_event_callbacks)
+    {
+        cb.accepted = 0;
+        cb.rejected = 0;
+    }
+    for (auto &route : _demux_routes)
+    {
+        route.frames = 0;
+    }
+    _rx_isr_hist.reset();
+    taskEXIT_CRITICAL();
+}
+
 /* Peripheral Management -----------------------------------------------------*/
 /**
  * @brief Performs a full peripheral reset (DeInit -> Init).
@@ -233,16 +995,42 @@ status_t uart_drv_t::reset(const uint32_t BaudRate, const uint32_t WordLength,
 }
 
 /* Custom RX Event Callback Management ---------------------------------------*/
+static_assert(std::is_trivially_copyable<uart_drv_t::rx_event_func>::value &&
+                  std::is_trivially_copyable<uart_drv_t::rx_span_func>::value,
+              "callback slots are copied inside critical sections");
+
 /**
  * @brief Registers a custom C++ RX event callback with an owner ID.
+ *
+ * The callback tables are fixed arrays of trivially copyable delegates, so
+ * registering never allocates. Slots are written inside a critical section,
+ * which masks the UART interrupts that read them.
+ *
+ * @return PYRO_BUSY if the UART has demux routes: each frame goes to exactly
+ * one consumer, so a UART is either demultiplexed or uses RX callbacks.
  */
-void uart_drv_t::add_rx_event_callback(const rx_event_func &func,
-                                       const uint32_t owner)
+status_t uart_drv_t::add_rx_event_callback(const rx_event_func func,
+                                           const uint32_t owner)
 {
-    rx_event_callback_t callback;
-    callback.owner = owner;
-    callback.func  = func;
-    rx_event_callbacks.push_back(callback);
+    status_t status = PYRO_NO_MEMORY;
+    taskENTER_CRITICAL();
+    for (auto &cb : _rx_event_callbacks)
+    {
+        if (_demux_route_num)
+        {
+            status = PYRO_BUSY;
+            break;
+        }
+        if (!cb.func.valid())
+        {
+            cb.owner = owner;
+            cb.func  = func;
+            status   = PYRO_OK;
+            break;
+        }
+    }
+    taskEXIT_CRITICAL();
+    return status;
 }
 
 /**
@@ -250,16 +1038,263 @@ void uart_drv_t::add_rx_event_callback(const rx_event_func &func,
  */
 status_t uart_drv_t::remove_rx_event_callback(const uint32_t owner)
 {
-    for (auto it = rx_event_callbacks.begin(); it != rx_event_callbacks.end();
-         ++it)
+    status_t status = PYRO_NOT_FOUND;
+    taskENTER_CRITICAL();
+    for (auto &cb : _rx_event_callbacks)
     {
-        if (it->owner == owner)
+        if (cb.func.valid() && cb.owner == owner)
         {
-            rx_event_callbacks.erase(it);
-            return PYRO_OK;
+            cb     = rx_event_callback_t{};
+            status = PYRO_OK;
+            break;
+        }
+    }
+    taskEXIT_CRITICAL();
+    return status;
+}
+
+/**
+ * @brief Registers a span callback with an owner ID (circular RX mode only).
+ */
+status_t uart_drv_t::add_rx_span_callback(const rx_span_func func,
+                                          const uint32_t owner)
+{
+    status_t status = PYRO_NO_MEMORY;
+    taskENTER_CRITICAL();
+    for (auto &cb : _rx_span_callbacks)
+    {
+        if (!cb.func.valid())
+        {
+            cb.owner = owner;
+            cb.func  = func;
+            status   = PYRO_OK;
+            break;
+        }
+    }
+    taskEXIT_CRITICAL();
+    return status;
+}
+
+/**
+ * @brief Removes a span callback based on the owner ID.
+ */
+status_t uart_drv_t::remove_rx_span_callback(const uint32_t owner)
+{
+    status_t status = PYRO_NOT_FOUND;
+    taskENTER_CRITICAL();
+    for (auto &cb : _rx_span_callbacks)
+    {
+        if (cb.func.valid() && cb.owner == owner)
+        {
+            cb     = rx_span_callback_t{};
+            status = PYRO_OK;
+            break;
+        }
+    }
+    taskEXIT_CRITICAL();
+    return status;
+}
+
+/* RX Demultiplexer ----------------------------------------------------------*/
+/**
+ * @brief Routes frames of one format to a consumer.
+ *
+ * Routes are tried in registration order and every frame goes to exactly one
+ * consumer, so formats that share sync bytes should be registered from the
+ * most specific one. In circular mode frames may span several DMA events;
+ * keep max_len at most half the ring so a frame is complete before the DMA
+ * can overwrite its start. In double-buffer mode only frames inside one DMA
+ * chunk are found.
+ *
+ * @return PYRO_BUSY if the UART already has RX event callbacks, which would
+ * see the routed frames a second time. Span callbacks may coexist.
+ */
+status_t uart_drv_t::add_demux_route(const demux_proto_t &proto,
+                                     const demux_func func,
+                                     const uint32_t owner)
+{
+    const uint16_t header =
+        proto.sync_len > proto.len_offset + proto.len_size
+            ? proto.sync_len
+            : proto.len_offset + proto.len_size;
+    if (0 == proto.sync_len || proto.sync_len > sizeof(proto.sync) ||
+        proto.len_size > 2 || proto.min_len < header ||
+        proto.min_len > proto.max_len || !func.valid())
+    {
+        return PYRO_PARAM_ERROR;
+    }
+
+    status_t status = PYRO_NO_MEMORY;
+    taskENTER_CRITICAL();
+    for (const auto &cb : _rx_event_callbacks)
+    {
+        if (cb.func.valid())
+        {
+            status = PYRO_BUSY;
+        }
+    }
+    for (auto &route : _demux_routes)
+    {
+        if (PYRO_BUSY == status)
+        {
+            break;
+        }
+        if (!route.func.valid())
+        {
+            route.owner = owner;
+            route.proto = proto;
+            route.func  = func;
+            _demux_sof_map[proto.sync[0] >> 5] |= 1UL << (proto.sync[0] & 0x1F);
+            _demux_route_num++;
+            status = PYRO_OK;
+            break;
         }
     }
-    return PYRO_NOT_FOUND;
+    taskEXIT_CRITICAL();
+    return status;
+}
+
+/**
+ * @brief Removes a demux route based on the owner ID.
+ */
+status_t uart_drv_t::remove_demux_route(const uint32_t owner)
+{
+    status_t status = PYRO_NOT_FOUND;
+    taskENTER_CRITICAL();
+    for (auto &route : _demux_routes)
+    {
+        if (route.func.valid() && route.owner == owner)
+        {
+            route = demux_route_t{};
+            _demux_route_num--;
+            status = PYRO_OK;
+            break;
+        }
+    }
+    _demux_sof_map.fill(0);
+    for (const auto &route : _demux_routes)
+    {
+        if (route.func.valid())
+        {
+            _demux_sof_map[route.proto.sync[0] >> 5] |=
+                1UL << (route.proto.sync[0] & 0x1F);
+        }
+    }
+    taskEXIT_CRITICAL();
+    return status;
+}
+
+const uart_drv_t::demux_stat_t &uart_drv_t::get_demux_stat() const
+{
+    return _demux_stat;
+}
+
+/**
+ * @brief Splits buf[idx, idx + avail) into frames (wrapping at buf_size) and
+ * hands each one to the first matching route, in a single pass.
+ *
+ * A byte that is not a registered first sync byte is skipped after one table
+ * lookup. Parsing stops at a frame whose header or body is still incomplete.
+ *
+ * @return Number of bytes parsed; the rest is the start of a partial frame.
+ */
+uint16_t uart_drv_t::demux(uint8_t *buf, const uint16_t buf_size, uint16_t idx,
+                           const uint16_t avail, BaseType_t *woken)
+{
+    const uint16_t len_limit = state.rx_circular ? buf_size / 2 : buf_size;
+    uint16_t done            = 0;
+    while (done < avail)
+    {
+        const uint16_t left = avail - done;
+        auto at             = [&](const uint16_t offset) -> uint8_t
+        {
+            const uint16_t pos = idx + offset;
+            return buf[pos >= buf_size ? pos - buf_size : pos];
+        };
+
+        const uint8_t sof = buf[idx];
+        demux_route_t *match = nullptr;
+        uint16_t frame_len         = 0;
+        bool wait                  = false;
+        if (_demux_sof_map[sof >> 5] & (1UL << (sof & 0x1F)))
+        {
+            for (auto &route : _demux_routes)
+            {
+                const demux_proto_t &proto = route.proto;
+                if (!route.func.valid())
+                {
+                    continue;
+                }
+                uint8_t k = 0;
+                while (k < proto.sync_len && k < left &&
+                       at(k) == proto.sync[k])
+                {
+                    k++;
+                }
+                if (k < proto.sync_len && k < left)
+                {
+                    continue; // Sync mismatch
+                }
+                if (left < proto.len_offset + proto.len_size ||
+                    left < proto.sync_len)
+                {
+                    wait = true; // Header incomplete
+                    break;
+                }
+                uint16_t len = proto.len_base;
+                for (k = 0; k < proto.len_size; k++)
+                {
+                    len += at(proto.len_offset + k) << (8 * k);
+                }
+                if (len < proto.min_len || len > proto.max_len ||
+                    len > len_limit)
+                {
+                    continue;
+                }
+                if (left < len)
+                {
+                    wait = true; // Body incomplete
+                    break;
+                }
+                match     = &route;
+                frame_len = len;
+                break;
+            }
+        }
+
+        if (match)
+        {
+            rx_span_t frame;
+            frame.first     = buf + idx;
+            frame.first_len = frame_len < buf_size - idx
+                                  ? frame_len
+                                  : static_cast<uint16_t>(buf_size - idx);
+            frame.second     = buf;
+            frame.second_len = frame_len - frame.first_len;
+            frame.overrun    = false;
+            match->func(frame, woken);
+            match->frames++;
+            _demux_stat.frames++;
+            _link_stat.frames_delivered++;
+            done += frame_len;
+            idx += frame_len;
+        }
+        else if (wait)
+        {
+            break;
+        }
+        else
+        {
+            _demux_stat.noise_bytes++;
+            done++;
+            idx++;
+        }
+        if (idx >= buf_size)
+        {
+            idx -= buf_size;
+        }
+    }
+    return done;
 }
 
 /* HAL Callback Registration -------------------------------------------------*/
@@ -321,34 +1356,32 @@ uart_drv_t::unregister_callback(const HAL_UART_CallbackIDTypeDef CB_ID) const
 /**
  * @brief HAL Extended RX Event Callback (triggered by DMA IDLE detection).
  *
- * This ISR-context function looks up the C++ driver instance and executes
- * registered C++ callbacks. If a callback consumes the data, the RX buffer
- * is switched and DMA reception is restarted. A FreeRTOS yield is performed
- * if a higher-priority task was woken.
+ * This ISR-context function looks up the C++ driver instance in the static
+ * instance table and hands the event to handle_rx_event(), which runs the
+ * registered callbacks, restarts or keeps the DMA running and yields if a
+ * higher-priority task was woken.
  */
 extern "C" void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart,
                                            uint16_t Size)
 {
-    const auto it = pyro::uart_drv_t::uart_map().find(huart);
-    static BaseType_t xHigherPriorityTaskWoken;
-    if (it != pyro::uart_drv_t::uart_map().end() && it->second)
+    const auto drv = pyro::uart_drv_t::from_handle(huart);
+    if (drv)
     {
-        const auto drv = it->second;
-        for (auto &cb : drv->rx_event_callbacks)
-        {
-            if (cb.func(drv->rx_buf[drv->rx_buf_switch], Size,
-                        xHigherPriorityTaskWoken))
-            {
-                drv->rx_buf_switch ^= 0x01U;
-                break;
-            }
-        }
-        drv->enable_rx_dma();
+        drv->handle_rx_event(Size);
     }
+}
 
-    if (xHigherPriorityTaskWoken)
+/**
+ * @brief HAL UART TX Complete Callback.
+ *
+ * Chains the next queued write straight from the interrupt.
+ */
+extern "C" void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+    const auto drv = pyro::uart_drv_t::from_handle(huart);
+    if (drv)
     {
-        portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+        drv->handle_tx_complete();
     }
 }
 
@@ -360,13 +1393,9 @@ extern "C" void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart,
  */
 extern "C" void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart)
 {
-    const auto it = pyro::uart_drv_t::uart_map().find(huart);
-    if (it != pyro::uart_drv_t::uart_map().end() && it->second)
+    const auto drv = pyro::uart_drv_t::from_handle(huart);
+    if (drv)
     {
-        const auto drv = it->second;
-        __HAL_UART_CLEAR_FLAG(huart, UART_CLEAR_PEF | UART_CLEAR_FEF |
-                                         UART_CLEAR_NEF | UART_CLEAR_OREF |
-                                         UART_CLEAR_RTOF);
-        drv->enable_rx_dma();
+        drv->handle_error();
     }
-}
\ No newline at end of file
+}
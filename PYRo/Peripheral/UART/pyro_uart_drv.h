@@ -23,9 +23,12 @@
 
 #include "FreeRTOS.h"
 
-#include "functional"
-#include "map"
-#include "vector"
+#include "delegate.h"
+#include "histogram.h"
+#include "pyro_uart_layout.h"
+
+#include "array"
+#include "atomic"
 
 namespace pyro
 {
@@ -36,8 +39,8 @@ class uart_drv_t;
  * @brief C++ class to encapsulate the STM32 HAL UART driver functionality.
  *
  * It manages double-buffering for DMA reception, integrates with FreeRTOS
- * for yielding from ISRs, and uses a static map to dispatch HAL callbacks
- * to the correct C++ instance.
+ * for yielding from ISRs, and uses a static instance table to dispatch HAL
+ * callbacks to the correct C++ instance.
  *
  * This class uses a Singleton pattern via `get_instance()` for access.
  */
@@ -45,22 +48,6 @@ class uart_drv_t
 {
 
     /* Private Types ---------------------------------------------------------*/
-    /**
-     * @brief Type alias for the RX event callback signature (for ISR context).
-     * @return true if the data was consumed and the RX buffer should switch.
-     */
-    using rx_event_func = std::function<bool(
-        uint8_t *p, uint16_t size, BaseType_t xHigherPriorityTaskWoken)>;
-
-    /**
-     * @brief Structure to store registered RX callbacks with an owner ID.
-     */
-    typedef struct rx_event_callback_t
-    {
-        uint32_t owner;
-        rx_event_func func;
-    } rx_event_callback_t;
-
     /**
      * @brief Internal state flags (bit-field) for tracking driver status.
      */
@@ -72,11 +59,151 @@ class uart_drv_t
         volatile uint8_t rx_dma_enable : 1;
         volatile uint8_t rx_busy       : 1;
         volatile uint8_t rx_error      : 1;
+        volatile uint8_t rx_circular   : 1;
     } state_t;
 
   public:
     /**
-     * @brief Enum to identify specific UART instances for the Singleton.
+     * @brief RX event callback (ISR context). Set *pxHigherPriorityTaskWoken
+     * through the FreeRTOS FromISR API to request a yield.
+     * @return true if the data was consumed and the RX buffer should switch.
+     */
+    using rx_event_func = delegate_t<bool(
+        uint8_t *p, uint16_t size, BaseType_t *pxHigherPriorityTaskWoken)>;
+
+    /**
+     * @brief Bytes received in the circular RX ring since the last event.
+     *
+     * The data continues from `first` into `second` when the span wraps at the
+     * end of the ring (`second_len` != 0). `overrun` is set when the DMA
+     * lapped the reader, i.e. older unread bytes were overwritten.
+     */
+    typedef struct rx_span_t
+    {
+        uint8_t *first;
+        uint16_t first_len;
+        uint8_t *second;
+        uint16_t second_len;
+        bool overrun;
+
+        uint16_t size() const
+        {
+            return first_len + second_len;
+        }
+    } rx_span_t;
+
+    /**
+     * @brief Type alias for the circular RX span callback (ISR context).
+     */
+    using rx_span_func = delegate_t<void(
+        const rx_span_t &span, BaseType_t *pxHigherPriorityTaskWoken)>;
+
+    /**
+     * @brief Dispatch cost of one RX event in CPU cycles.
+     */
+    using rx_isr_hist_t = histogram_t<16>;
+
+    static constexpr uint8_t MAX_UART_NUM        = 8;
+    static constexpr uint8_t INSTANCE_SLOT_NUM   = 32;
+    static constexpr uint8_t MAX_RX_CALLBACK_NUM = 4; // Per kind, per UART
+    static constexpr uint8_t MAX_DEMUX_ROUTE_NUM = 4;
+
+    /**
+     * @brief Frame format matched by the RX demultiplexer.
+     *
+     * A frame starts with `sync_len` sync bytes. Its total length is
+     * `len_base` plus the little-endian `len_size`-byte field at `len_offset`,
+     * or exactly `len_base` for fixed-length frames (`len_size` = 0). Lengths
+     * outside [min_len, max_len] do not match.
+     */
+    typedef struct demux_proto_t
+    {
+        uint8_t sync[4];
+        uint8_t sync_len;
+        uint8_t len_offset;
+        uint8_t len_size;
+        uint16_t len_base;
+        uint16_t min_len;
+        uint16_t max_len;
+    } demux_proto_t;
+
+    /**
+     * @brief Receives one complete frame by reference (ISR context). The span
+     * points into the RX buffer and is only valid during the call.
+     */
+    using demux_func = delegate_t<void(const rx_span_t &frame,
+                                       BaseType_t *pxHigherPriorityTaskWoken)>;
+
+    typedef struct demux_stat_t
+    {
+        volatile uint32_t frames;      // Frames routed to a consumer
+        volatile uint32_t noise_bytes; // Bytes skipped while resyncing
+        volatile uint32_t dropped;     // Partial frames lost to an overrun
+    } demux_stat_t;
+
+    /**
+     * @brief RX link counters, cheap enough to stay enabled in match builds.
+     */
+    typedef struct link_stat_t
+    {
+        volatile uint32_t rx_bytes;         // Bytes received
+        volatile uint32_t rx_events;        // HAL RX events (IDLE/HT/TC)
+        volatile uint32_t frames_delivered; // Accepted by a callback or route
+        volatile uint32_t frames_unclaimed; // Rejected by every callback
+        volatile uint32_t parity_errors;
+        volatile uint32_t noise_errors;
+        volatile uint32_t framing_errors;
+        volatile uint32_t overrun_errors;   // UART ORE, a byte was lost
+        volatile uint32_t dma_errors;
+        volatile uint32_t ring_overruns;    // Circular ring lapped the reader
+        volatile uint32_t dma_restarts;     // Reception re-armed after an error
+        volatile uint32_t dma_rearms;       // Per-frame re-arms, double buffer
+        uint32_t rx_isr_max_cycles;         // Longest RX event dispatch
+    } link_stat_t;
+
+    /**
+     * @brief Per-consumer counters, callbacks and demux routes alike.
+     */
+    typedef struct consumer_stat_t
+    {
+        uint32_t owner;
+        uint32_t accepted;
+        uint32_t rejected; // Always 0 for demux routes
+    } consumer_stat_t;
+
+    static constexpr uint8_t TX_DESC_NUM = 16; // Queued writes
+
+    /**
+     * @brief Buffer configuration of one UART, applied when its instance is
+     * created. The memory must be DMA-reachable (not DTCM); leave both
+     * allocator hooks nullptr to use the DMA heap. The buffers are placed
+     * by plan_uart_layout() (pyro_uart_layout.h).
+     */
+    typedef struct uart_desc_t
+    {
+        UART_HandleTypeDef *huart;
+        uart_buf_cfg_t buf;
+        void *(*mem_alloc)(size_t size);
+        void (*mem_free)(void *p);
+    } uart_desc_t;
+
+    /**
+     * @brief TX queue statistics.
+     */
+    typedef struct tx_stat_t
+    {
+        volatile uint32_t tx_bytes;       // Bytes sent by DMA
+        volatile uint32_t tx_writes;      // Queued writes completed
+        volatile uint32_t tx_bursts;      // DMA transfers started
+        volatile uint32_t tx_dropped;     // Writes rejected, queue full
+        volatile uint32_t tx_errors;      // Transfers aborted by an error
+        volatile uint16_t high_water;     // Max bytes queued
+        volatile uint8_t desc_high_water; // Max writes queued
+        float tx_bps;                     // Bytes/s since the previous query
+    } tx_stat_t;
+
+    /**
+     * @brief Board UARTs covered by the default descriptor table.
      */
     enum which_uart
     {
@@ -89,9 +216,9 @@ class uart_drv_t
     /* Public Methods - Initialization and De-initialization
      * -------------------*/
     /**
-     * @brief Private constructor. Called by `get_instance()`.
+     * @brief Constructor. Called by `get_instance()`.
      */
-    explicit uart_drv_t(UART_HandleTypeDef *huart, uint16_t buf_length);
+    explicit uart_drv_t(const uart_desc_t &desc);
     /**
      * @brief Destructor.
      */
@@ -102,9 +229,17 @@ class uart_drv_t
     status_t reset(uint32_t BaudRate, uint32_t WordLength, uint32_t StopBits,
                    uint32_t Parity);
     /**
-     * @brief Accessor for the UART driver Singleton instance.
+     * @brief Replaces the descriptor table before any instance is created.
+     */
+    static status_t config(const uart_desc_t *table, uint8_t num);
+    /**
+     * @brief Accessor for the UART driver instance of a board UART.
      */
     static uart_drv_t *get_instance(which_uart uart);
+    /**
+     * @brief Accessor for the UART driver instance of any configured UART.
+     */
+    static uart_drv_t *get_instance(UART_HandleTypeDef *huart);
 
     /* Public Methods - Transmission
      * -------------------------------------------*/
@@ -114,9 +249,33 @@ class uart_drv_t
     status_t write(const uint8_t *p, uint16_t size,
                    uint32_t waittime); // Polling
     /**
-     * @brief Non-blocking (DMA) write.
+     * @brief Non-blocking (DMA) write through the TX queue.
      */
     status_t write(const uint8_t *p, uint16_t size); // DMA
+    /**
+     * @brief Returns a fence covering every write queued so far.
+     */
+    uint16_t tx_fence() const;
+    /**
+     * @brief Checks whether all writes before a fence have been sent.
+     */
+    bool tx_done(uint16_t fence) const;
+    /**
+     * @brief Waits until all writes queued so far have been sent (task).
+     */
+    status_t flush(uint32_t timeout_ms);
+    /**
+     * @brief Copies the TX queue statistics and updates the throughput.
+     */
+    status_t get_tx_stat(tx_stat_t &stat);
+    /**
+     * @brief Retires the finished DMA burst and starts the next (ISR).
+     */
+    void handle_tx_complete();
+    /**
+     * @brief Drops the burst aborted by a TX DMA error (ISR).
+     */
+    void handle_tx_error();
 
     /* Public Methods - Reception Control
      * --------------------------------------*/
@@ -128,17 +287,40 @@ class uart_drv_t
      * @brief Aborts DMA reception.
      */
     status_t disable_rx_dma() const;
+    /**
+     * @brief Switches reception to circular DMA into a ring buffer.
+     */
+    status_t enable_rx_circular();
 
     /* Public Methods - Custom Callback Management
      * -----------------------------*/
     /**
-     * @brief Adds a C++ RX event callback.
+     * @brief Adds a C++ RX event callback, not on a UART with demux routes.
      */
-    void add_rx_event_callback(const rx_event_func &func, uint32_t owner);
+    status_t add_rx_event_callback(rx_event_func func, uint32_t owner);
     /**
      * @brief Removes a C++ RX event callback by its owner ID.
      */
     status_t remove_rx_event_callback(uint32_t);
+    /**
+     * @brief Adds a span callback, only called in circular RX mode.
+     */
+    status_t add_rx_span_callback(rx_span_func func, uint32_t owner);
+    /**
+     * @brief Removes a span callback by its owner ID.
+     */
+    status_t remove_rx_span_callback(uint32_t owner);
+    /**
+     * @brief Routes frames matching a format to one consumer, not on a UART
+     * with RX event callbacks.
+     */
+    status_t add_demux_route(const demux_proto_t &proto, demux_func func,
+                             uint32_t owner);
+    /**
+     * @brief Removes a demux route by its owner ID.
+     */
+    status_t remove_demux_route(uint32_t owner);
+    const demux_stat_t &get_demux_stat() const;
 
     /* Public Methods - HAL Callback Registration
      * ------------------------------*/
@@ -163,14 +345,52 @@ class uart_drv_t
     /* Public Methods - Static Access
      * ----------------------------------------*/
     /**
-     * @brief Provides access to the static map linking HAL handles to
-     * instances.
+     * @brief Looks up the driver instance of a HAL handle (ISR-safe, O(1)).
+     */
+    static uart_drv_t *from_handle(const UART_HandleTypeDef *huart);
+    /**
+     * @brief Slot of a U(S)ART peripheral in the ISR lookup table. Bits
+     * [14:10] of the base address tell every U(S)ART of the H7 apart.
      */
-    static std::map<UART_HandleTypeDef *, uart_drv_t *> &uart_map();
+    static constexpr uint8_t instance_slot(const uintptr_t base)
+    {
+        return static_cast<uint8_t>((base >> 10) & (INSTANCE_SLOT_NUM - 1));
+    }
+
+    /* Public Methods - ISR Entry
+     * ---------------------------------------------*/
+    /**
+     * @brief Dispatches a HAL RX event to the registered callbacks.
+     */
+    void handle_rx_event(uint16_t size);
+    /**
+     * @brief Counts the errors of a HAL error callback and recovers (ISR).
+     */
+    void handle_error();
+    /**
+     * @brief Cycle histogram of handle_rx_event() (callbacks included).
+     */
+    const rx_isr_hist_t &get_rx_isr_hist() const;
+    /**
+     * @brief CYCCNT at entry of the RX event being dispatched, for latency
+     * tracing from inside RX callbacks.
+     */
+    uint32_t get_rx_event_ticks() const;
+    /**
+     * @brief Copies the RX link counters.
+     */
+    void get_link_stat(link_stat_t &stat) const;
+    /**
+     * @brief Copies the per-consumer counters, returns the number written.
+     */
+    uint8_t get_consumer_stat(consumer_stat_t *stat, uint8_t max_num) const;
+    /**
+     * @brief Clears the link, consumer, demux and dispatch-time counters.
+     */
+    void reset_link_stat();
 
     /* Public Members - State/Data
      * ------------------------------------*/
-    std::vector<rx_event_callback_t> rx_event_callbacks;
     uint8_t *rx_buf[2];      // Double buffers for DMA reception
     uint8_t rx_buf_switch{}; // Index of the currently active buffer
     state_t state{};
@@ -179,8 +399,99 @@ class uart_drv_t
   private:
     /* Private Members
      * ---------------------------------------------------------*/
+    /**
+     * @brief Registered callbacks, an invalid func marks a free slot.
+     */
+    typedef struct rx_event_callback_t
+    {
+        uint32_t owner;
+        rx_event_func func;
+        volatile uint32_t accepted;
+        volatile uint32_t rejected;
+    } rx_event_callback_t;
+
+    typedef struct rx_span_callback_t
+    {
+        uint32_t owner;
+        rx_span_func func;
+    } rx_span_callback_t;
+
+    // Instance i is created from descriptor i
+    inline static std::array<uart_desc_t, MAX_UART_NUM> _desc_table{};
+    inline static std::array<uart_drv_t *, MAX_UART_NUM> _instances{};
+    inline static uint8_t _desc_num{};
+    // Same drivers by peripheral, see instance_slot(). Filled when an
+    // instance is created, so the HAL callbacks need a single load
+    inline static std::array<uart_drv_t *, INSTANCE_SLOT_NUM> _slot_map{};
+
     UART_HandleTypeDef *_huart; // HAL handle for the peripheral
     uint16_t _rx_buf_size{};    // Size of each RX buffer
+    uint8_t *_mem_raw{};        // Buffer block as allocated
+    void (*_mem_free)(void *p);
+
+    std::array<rx_event_callback_t, MAX_RX_CALLBACK_NUM> _rx_event_callbacks{};
+    std::array<rx_span_callback_t, MAX_RX_CALLBACK_NUM> _rx_span_callbacks{};
+    rx_isr_hist_t _rx_isr_hist;
+    uint32_t _rx_event_cnt{}; // CYCCNT at handle_rx_event() entry
+
+    typedef struct demux_route_t
+    {
+        uint32_t owner;
+        demux_proto_t proto;
+        demux_func func;
+        volatile uint32_t frames;
+    } demux_route_t;
+
+    bool dispatch_frame(uint8_t *p, uint16_t size, BaseType_t *woken);
+
+    uint16_t demux(uint8_t *buf, uint16_t buf_size, uint16_t idx,
+                   uint16_t avail, BaseType_t *woken);
+
+    std::array<demux_route_t, MAX_DEMUX_ROUTE_NUM> _demux_routes{};
+    std::array<uint32_t, 8> _demux_sof_map{}; // Bit per first sync byte
+    uint8_t _demux_route_num{};
+    uint16_t _demux_idx{}; // Ring position of the first unparsed byte
+    demux_stat_t _demux_stat{};
+
+    status_t start_rx_circular();
+    void handle_rx_circular(uint16_t size, HAL_UART_RxEventTypeTypeDef type,
+                            BaseType_t *woken);
+
+    /**
+     * @brief One queued write, its bytes live in the TX ring.
+     */
+    typedef struct tx_desc_t
+    {
+        uint16_t pos;           // Free-running ring position of the first byte
+        uint16_t len;
+        volatile uint8_t ready; // Set once the bytes are copied in
+    } tx_desc_t;
+
+    void pump_tx();
+    bool start_tx();
+    void retire_tx(uint16_t sent);
+
+    uint8_t *_tx_ring{};               // TX ring (.dma_heap)
+    uint16_t _tx_ring_size{};          // Power of two, 0 if there is no queue
+    // [31:16] write sequence, [15:0] free-running byte position. Producers
+    // reserve both with one CAS, so writers never wait for each other.
+    std::atomic<uint32_t> _tx_head{0};
+    volatile uint16_t _tx_byte_tail{}; // Bytes sent, written by the owner only
+    volatile uint16_t _tx_desc_tail{}; // Writes retired
+    uint16_t _tx_inflight{};           // Bytes of the running burst
+    std::atomic<bool> _tx_active{false}; // Owner of the TX DMA
+    tx_desc_t _tx_desc[TX_DESC_NUM]{};
+    tx_stat_t _tx_stat{};
+    uint32_t _tx_stat_cnt_last{};
+    uint32_t _tx_stat_bytes_last{};
+
+    uint8_t *_rx_ring{};             // Circular DMA ring (.dma_heap)
+    uint16_t _rx_ring_size{};        // Ring size in bytes
+    uint16_t _rx_read_idx{};         // Ring position consumed so far
+    uint16_t _rx_frame_idx{};        // Start of the current idle frame
+    uint16_t _rx_frame_len{};        // Bytes in the current idle frame
+    bool _rx_frame_overrun{};        // Current idle frame was overwritten
+    link_stat_t _link_stat{};
 };
 
 } // namespace pyro
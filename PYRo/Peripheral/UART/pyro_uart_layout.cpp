@@ -0,0 +1,54 @@
+/**
+ * @file pyro_uart_layout.cpp
+ * @brief Buffer layout of the UART driver, independent of the HAL.
+ *
+ * @version 1.0.0
+ * @date 2026-10-17
+ */
+
+#include "pyro_uart_layout.h"
+
+namespace pyro
+{
+/**
+ * @brief A TX ring is used only if it is a power of two that the 16-bit
+ * free-running positions can address.
+ */
+bool uart_tx_ring_valid(const uint16_t size)
+{
+    return size && size <= 0x8000 && 0 == (size & (size - 1));
+}
+
+/**
+ * @brief Places the buffers of a descriptor in one block.
+ *
+ * Every buffer starts on a cache line and is padded to a whole number of
+ * lines, so cache maintenance on one buffer never touches its neighbour.
+ * With a single RX buffer both rx_buf entries share offset 0. Sizes are
+ * zero for buffers the descriptor does not ask for, and an invalid TX ring
+ * size is treated as none.
+ */
+uart_buf_layout_t plan_uart_layout(const uart_buf_cfg_t &cfg)
+{
+    const auto lines = [](const size_t size) -> size_t
+    {
+        return (size + UART_CACHE_LINE - 1) &
+               ~static_cast<size_t>(UART_CACHE_LINE - 1);
+    };
+
+    uart_buf_layout_t layout{};
+    if (0 == cfg.rx_buf_size || 0 == cfg.rx_buf_num || cfg.rx_buf_num > 2)
+    {
+        return layout;
+    }
+    layout.rx_buf[0] = 0;
+    layout.rx_buf[1] = cfg.rx_buf_num > 1 ? lines(cfg.rx_buf_size) : 0;
+    layout.rx_ring   = layout.rx_buf[1] + lines(cfg.rx_buf_size);
+    layout.tx_ring   = layout.rx_ring + lines(cfg.rx_ring_size);
+    layout.size      = layout.tx_ring + (uart_tx_ring_valid(cfg.tx_ring_size)
+                                             ? lines(cfg.tx_ring_size)
+                                             : 0);
+    layout.alloc_size = layout.size + UART_CACHE_LINE - 1;
+    return layout;
+}
+} // namespace pyro
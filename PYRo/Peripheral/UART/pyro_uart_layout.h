@@ -0,0 +1,61 @@
+/**
+ * @file pyro_uart_layout.h
+ * @brief Buffer layout of the UART driver, independent of the HAL.
+ *
+ * Each UART gets one block that holds its RX buffers, circular RX ring and
+ * TX ring. plan_uart_layout() decides where each buffer goes from the sizes
+ * in the descriptor alone, so the layout can be checked off-target.
+ *
+ * @version 1.0.0
+ * @date 2026-10-17
+ */
+
+#ifndef __PYRO_UART_LAYOUT_H__
+#define __PYRO_UART_LAYOUT_H__
+
+#include <cstddef>
+#include <cstdint>
+
+namespace pyro
+{
+constexpr uint8_t UART_CACHE_LINE = 32; // Cortex-M7 D-cache line
+
+/**
+ * @brief Buffer sizes of one UART, the memory part of its descriptor.
+ */
+typedef struct uart_buf_cfg_t
+{
+    uint16_t rx_buf_size;  // Each double-buffer RX buffer
+    uint8_t rx_buf_num;    // 1 or 2
+    uint16_t rx_ring_size; // Circular RX ring, 0 = none
+    uint16_t tx_ring_size; // TX queue, power of two, 0 = none
+} uart_buf_cfg_t;
+
+/**
+ * @brief Byte offsets of the buffers in a UART's memory block.
+ */
+typedef struct uart_buf_layout_t
+{
+    size_t rx_buf[2];
+    size_t rx_ring;
+    size_t tx_ring;
+    size_t size;       // Whole block, a multiple of UART_CACHE_LINE, 0 if
+                       // the configuration is invalid
+    size_t alloc_size; // Bytes to allocate so the block can be aligned
+} uart_buf_layout_t;
+
+/**
+ * @brief Sizes of the default descriptor table, in which_uart order.
+ */
+constexpr uart_buf_cfg_t uart_default_buf_cfg[] = {
+    {42, 2, 512, 1024}, // uart1: referee + VT03 (circular RX), VOFA/JCOM
+    {36, 2, 0, 0},      // uart5: DR16, RX only
+    {48, 2, 0, 0},      // uart7: no TX DMA
+    {64, 2, 0, 512},    // uart10
+};
+
+bool uart_tx_ring_valid(uint16_t size);
+uart_buf_layout_t plan_uart_layout(const uart_buf_cfg_t &cfg);
+} // namespace pyro
+
+#endif
@@ -0,0 +1,105 @@
+/**
+ * @file pyro_algo_ols_ref.h
+ * @brief The original shifting OLS (PYRo 1.0.0), kept as a test reference.
+ *
+ * Shifts both sample arrays and re-sums the whole window on every update.
+ * Only used by the host tests to check ols_buf_t against it.
+ *
+ * @author Wang Hongxi (Original C)
+ * @author Lucky (C++ Refactor)
+ * @version 1.0.0
+ * @date 2025-11-13
+ */
+
+#ifndef __PYRO_ALGO_OLS_REF_H__
+#define __PYRO_ALGO_OLS_REF_H__
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace pyro
+{
+class ols_ref_t
+{
+  public:
+    explicit ols_ref_t(uint16_t order)
+        : _order(order < 2 ? 2 : order), _x(_order, 0.0f), _y(_order, 0.0f)
+    {
+    }
+
+    void update(const float deltax, const float y)
+    {
+        const float temp = _x[1];
+        for (uint16_t i = 0; i < _order - 1; ++i)
+        {
+            _x[i] = _x[i + 1] - temp;
+            _y[i] = _y[i + 1];
+        }
+        _x[_order - 1] = _x[_order - 2] + deltax;
+        _y[_order - 1] = y;
+
+        if (_count < _order)
+        {
+            _count++;
+        }
+
+        float t[4]                 = {0.0f, 0.0f, 0.0f, 0.0f};
+        const uint16_t start_index = _order - _count;
+        for (uint16_t i = start_index; i < _order; ++i)
+        {
+            t[0] += _x[i] * _x[i];
+            t[1] += _x[i];
+            t[2] += _x[i] * _y[i];
+            t[3] += _y[i];
+        }
+
+        const float denominator =
+            (t[0] * static_cast<float>(_order) - t[1] * t[1]);
+        if (std::fabs(denominator) > 1e-9f)
+        {
+            _k = (t[2] * static_cast<float>(_order) - t[1] * t[3]) /
+                 denominator;
+            _b = (t[0] * t[3] - t[1] * t[2]) / denominator;
+        }
+        else
+        {
+            _k = 0.0f;
+            _b = (_count > 0) ? (t[3] / static_cast<float>(_count)) : 0.0f;
+        }
+
+        _deviation = 0.0f;
+        for (uint16_t i = start_index; i < _order; ++i)
+        {
+            _deviation += std::fabs(_k * _x[i] + _b - _y[i]);
+        }
+        _deviation /= static_cast<float>(_order);
+    }
+
+    float get_derivative() const
+    {
+        return _k;
+    }
+
+    float get_smooth() const
+    {
+        return _k * _x.back() + _b;
+    }
+
+    float get_mean_absolute_deviation() const
+    {
+        return _deviation;
+    }
+
+  private:
+    uint16_t _order;
+    uint32_t _count{};
+    std::vector<float> _x;
+    std::vector<float> _y;
+    float _k{};
+    float _b{};
+    float _deviation{};
+};
+} // namespace pyro
+
+#endif
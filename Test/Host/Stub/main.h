@@ -0,0 +1,52 @@
+/**
+ * @file main.h
+ * @brief Host stand-in for the CubeMX main.h.
+ *
+ * Algorithm sources include main.h only for the DWT cycle counter used by
+ * the profiler. Here it is a plain variable that never counts, and the
+ * profiler macros are compiled out with PROFILE_DEBUG_EN = 0. The DWT test
+ * builds the real dwt_drv_t against it and drives CYCCNT through a read
+ * hook, so it can move the count (or preempt the reader) on every sample.
+ */
+
+#ifndef __MAIN_H
+#define __MAIN_H
+
+#include <stdint.h>
+
+struct host_cyccnt_t
+{
+    uint32_t value;
+    uint32_t (*read)(); // Replaces reading value when set
+
+    operator uint32_t() const
+    {
+        return read ? read() : value;
+    }
+    host_cyccnt_t &operator=(const uint32_t v)
+    {
+        value = v;
+        return *this;
+    }
+};
+
+typedef struct
+{
+    volatile uint32_t CTRL;
+    host_cyccnt_t CYCCNT;
+} host_dwt_t;
+
+typedef struct
+{
+    volatile uint32_t DEMCR;
+} host_core_debug_t;
+
+inline host_dwt_t host_dwt;
+inline host_core_debug_t host_core_debug;
+#define DWT       (&host_dwt)
+#define CoreDebug (&host_core_debug)
+
+#define DWT_CTRL_CYCCNTENA_Msk     (1UL)
+#define CoreDebug_DEMCR_TRCENA_Msk (1UL << 24)
+
+#endif
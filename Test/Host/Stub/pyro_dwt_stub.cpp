@@ -0,0 +1,33 @@
+/**
+ * @file pyro_dwt_stub.cpp
+ * @brief dwt_drv_t on the host: get_delta_t() returns a value set by the
+ * test, so the DWT-timed PID paths see exactly the dt the test chose.
+ */
+
+#include "pyro_dwt_drv.h"
+#include "pyro_dwt_stub.h"
+
+namespace
+{
+float stub_dt        = 0.0f;
+uint32_t stub_cycles = 0;
+} // namespace
+
+namespace pyro
+{
+void host_test::set_delta_t(const float dt)
+{
+    stub_dt = dt;
+}
+
+float dwt_drv_t::get_delta_t(uint32_t *cnt_last)
+{
+    *cnt_last = ++stub_cycles;
+    return stub_dt;
+}
+
+uint32_t dwt_drv_t::get_current_ticks()
+{
+    return ++stub_cycles;
+}
+} // namespace pyro
@@ -0,0 +1,20 @@
+/**
+ * @file pyro_dwt_stub.h
+ * @brief Host control of the stubbed dwt_drv_t used by the PID tests.
+ */
+
+#ifndef __PYRO_DWT_STUB_H__
+#define __PYRO_DWT_STUB_H__
+
+namespace pyro
+{
+namespace host_test
+{
+/**
+ * @brief Value every dwt_drv_t::get_delta_t() call returns from now on.
+ */
+void set_delta_t(float dt);
+} // namespace host_test
+} // namespace pyro
+
+#endif
@@ -0,0 +1,103 @@
+/**
+ * @file pyro_direct_map_bench.cpp
+ * @brief Lookup cost of direct_map_t with 1, 8, 32 and 64 registered IDs.
+ *
+ * Host nanoseconds per lookup over the CAN RX table shape (11-bit IDs, 64
+ * slots), with the key mix half registered IDs and half misses. A linear
+ * scan doing exist() then operator[] like the old map_t is printed beside
+ * it for scale. Only the trend matters: the direct map should stay flat.
+ */
+
+#include "direct_map.h"
+#include "pyro_host_test.h"
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+
+namespace
+{
+constexpr size_t KEY_RANGE  = 0x800;
+constexpr size_t CAPACITY   = 64;
+constexpr long LOOKUP_NUM   = 20000000;
+constexpr size_t KEY_MIX    = 1024; // power of two
+
+using table_t = pyro::direct_map_t<const void *, KEY_RANGE, CAPACITY>;
+
+/**
+ * @brief Two passes over the registered keys, as map_t::exist() followed by
+ * map_t::operator[] did on every frame.
+ */
+struct linear_t
+{
+    std::array<uint16_t, CAPACITY> keys{};
+    std::array<const void *, CAPACITY> values{};
+    size_t size = 0;
+
+    int find(const size_t key) const
+    {
+        for (size_t i = 0; i < size; i++)
+        {
+            if (key == keys[i])
+            {
+                return static_cast<int>(i);
+            }
+        }
+        return -1;
+    }
+
+    const void *lookup(const size_t key) const
+    {
+        return find(key) != -1 ? values[find(key)] : nullptr;
+    }
+};
+
+template <typename Table>
+double bench(const Table &table, const std::array<uint16_t, KEY_MIX> &mix)
+{
+    volatile uintptr_t sink = 0;
+    const double ns = pyro::host_test::ns_per_iter(LOOKUP_NUM, [&](long i) {
+        sink = sink + reinterpret_cast<uintptr_t>(
+                          table.lookup(mix[i & (KEY_MIX - 1)]));
+    });
+    (void)sink;
+    return ns;
+}
+} // namespace
+
+int main()
+{
+    static int value[CAPACITY];
+    std::printf("registered  direct ns  linear ns\n");
+    for (const size_t num : {1, 8, 32, 64})
+    {
+        std::mt19937 rng(static_cast<uint32_t>(num));
+        std::uniform_int_distribution<uint16_t> any_id(0, KEY_RANGE - 1);
+
+        static table_t direct;
+        direct.clear();
+        linear_t linear;
+        std::array<uint16_t, CAPACITY> ids{};
+        while (linear.size < num)
+        {
+            const uint16_t id = any_id(rng);
+            if (direct.insert(id, &value[linear.size]))
+            {
+                ids[linear.size]           = id;
+                linear.keys[linear.size]   = id;
+                linear.values[linear.size] = &value[linear.size];
+                linear.size++;
+            }
+        }
+
+        std::array<uint16_t, KEY_MIX> mix{};
+        for (size_t i = 0; i < KEY_MIX; i++)
+        {
+            mix[i] = (i & 1) ? any_id(rng) : ids[rng() % num];
+        }
+        std::printf("%10zu  %9.2f  %9.2f\n", num, bench(direct, mix),
+                    bench(linear, mix));
+    }
+    return 0;
+}
@@ -0,0 +1,69 @@
+/**
+ * @file pyro_dwt_bench.cpp
+ * @brief Cost of the dwt_drv_t 64-bit timeline.
+ *
+ * Host nanoseconds per call with CYCCNT advancing on every read, so the
+ * wrap state is republished every 2^24 cycles as on target. The plain
+ * 64-bit division is printed beside the timeline conversions for scale;
+ * the host divides in hardware, so only on the M7 (which calls a library
+ * helper) does divide() pull clearly ahead.
+ */
+
+#include "main.h"
+#include "pyro_dwt_drv.h"
+#include "pyro_host_test.h"
+
+#include <cstdio>
+
+namespace
+{
+constexpr uint32_t CPU_FREQ_MHZ = 480;
+constexpr long CALL_NUM         = 20000000;
+
+uint64_t now = 0;
+
+uint32_t read_cyccnt()
+{
+    now += 4099; // Prime, so the low bits keep changing
+    return static_cast<uint32_t>(now);
+}
+
+template <typename F> double bench(F &&body)
+{
+    volatile uint64_t sink = 0;
+    const double ns        = pyro::host_test::ns_per_iter(
+        CALL_NUM, [&](long) { sink = sink + body(); });
+    (void)sink;
+    return ns;
+}
+} // namespace
+
+int main()
+{
+    using pyro::dwt_drv_t;
+
+    host_dwt.CYCCNT.read = read_cyccnt;
+    dwt_drv_t::init(CPU_FREQ_MHZ);
+
+    std::printf("call                        ns\n");
+    std::printf("get_current_ticks()   %8.2f\n",
+                bench([] { return dwt_drv_t::get_current_ticks(); }));
+    std::printf("get_cycles()          %8.2f\n",
+                bench([] { return dwt_drv_t::get_cycles(); }));
+    std::printf("get_timeline_us()     %8.2f\n",
+                bench([] { return dwt_drv_t::get_timeline_us(); }));
+    std::printf("get_cycles() / 480    %8.2f\n", bench([] {
+                    volatile uint32_t freq_us = CPU_FREQ_MHZ;
+                    return dwt_drv_t::get_cycles() / freq_us;
+                }));
+    std::printf("get_timeline()        %8.2f\n", bench([] {
+                    const dwt_drv_t::time_t t = dwt_drv_t::get_timeline();
+                    return static_cast<uint64_t>(t.s) + t.ms + t.us;
+                }));
+    std::printf("get_timeline_s()      %8.2f\n", bench([] {
+                    return static_cast<uint64_t>(dwt_drv_t::get_timeline_s());
+                }));
+    std::printf("clock advanced %llu wraps\n",
+                static_cast<unsigned long long>(now >> 32));
+    return 0;
+}
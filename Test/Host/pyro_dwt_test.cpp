@@ -0,0 +1,296 @@
+/**
+ * @file pyro_dwt_test.cpp
+ * @brief dwt_drv_t 64-bit timeline over a fake CYCCNT, and divide().
+ *
+ * The driver is built from the firmware source against Stub/main.h, whose
+ * CYCCNT read hook returns the low 32 bits of a 64-bit test clock. The
+ * clock walks across 0xFFFFFFFF -> 0 many times, in steps up to the 255/256
+ * wrap period the driver needs between refreshes. Every get_cycles() must
+ * return exactly the 64-bit count at the instant it sampled CYCCNT, which
+ * also makes the timeline monotonic in sample order.
+ *
+ * Preemption is injected inside the read hook: nested readers run either
+ * between the state load and the CYCCNT sample or between the sample and
+ * the CAS, so the interrupted reader works from a state word the nested
+ * ones already replaced.
+ */
+
+#include "main.h"
+#include "pyro_dwt_drv.h"
+#include "pyro_host_test.h"
+
+#include <cstdio>
+#include <random>
+
+namespace pyro
+{
+namespace host_test
+{
+struct dwt_probe_t
+{
+    static uint64_t divide(const uint64_t n, const uint32_t d)
+    {
+        return dwt_drv_t::divide(n, dwt_drv_t::make_divisor(d));
+    }
+};
+} // namespace host_test
+} // namespace pyro
+
+namespace
+{
+using pyro::dwt_drv_t;
+using pyro::host_test::check;
+
+constexpr uint32_t CPU_FREQ_MHZ = 480;
+constexpr uint64_t FREQ_HZ      = CPU_FREQ_MHZ * 1000000ULL;
+constexpr uint64_t MAX_GAP      = 0xFF000000; // 255/256 of a wrap
+constexpr long STEP_NUM         = 200000;
+constexpr int NESTED_MAX        = 3;          // Per side of the sample
+constexpr uint64_t NESTED_STEP  = 0x02000000; // Largest nested step
+
+uint64_t now          = 0; // True cycle count since init()
+uint64_t outer_sample = 0; // now when the outermost reader sampled CYCCNT
+int depth             = 0;
+
+// Nested readers injected into the next outermost sample
+struct preempt_t
+{
+    int before; // Between the state load and the CYCCNT sample
+    int after;  // Between the sample and the CAS
+    uint64_t step;
+} preempt{};
+
+void run_nested(const int num)
+{
+    for (int i = 0; i < num; i++)
+    {
+        now += preempt.step;
+        const uint64_t expect = now;
+        const uint64_t got    = dwt_drv_t::get_cycles();
+        check(got == expect, "nested reader: %llx, expected %llx",
+              static_cast<unsigned long long>(got),
+              static_cast<unsigned long long>(expect));
+    }
+}
+
+uint32_t read_cyccnt()
+{
+    if (depth > 0)
+    {
+        return static_cast<uint32_t>(now);
+    }
+    depth++;
+    run_nested(preempt.before);
+    outer_sample = now;
+    run_nested(preempt.after);
+    depth--;
+    return static_cast<uint32_t>(outer_sample);
+}
+
+/**
+ * @brief One outermost reader after advancing the clock by step.
+ */
+uint64_t read(const uint64_t step, const preempt_t &p = {})
+{
+    now += step;
+    preempt            = p;
+    const uint64_t got = dwt_drv_t::get_cycles();
+    preempt            = {};
+    check(got == outer_sample, "reader: %llx, expected %llx",
+          static_cast<unsigned long long>(got),
+          static_cast<unsigned long long>(outer_sample));
+    return got;
+}
+
+/**
+ * @brief Readers that leave the clock lead cycles below the next wrap.
+ */
+void park_below_wrap(const uint64_t lead)
+{
+    uint64_t to_wrap = 0x100000000ULL - static_cast<uint32_t>(now);
+    if (to_wrap < lead)
+    {
+        read(to_wrap);
+        to_wrap = 0x100000000ULL;
+    }
+    uint64_t step = to_wrap - lead;
+    if (step > MAX_GAP)
+    {
+        read(step - MAX_GAP);
+        step = MAX_GAP;
+    }
+    read(step);
+}
+
+void check_conversions()
+{
+    const uint64_t us = dwt_drv_t::get_timeline_us();
+    check(us == now / CPU_FREQ_MHZ, "timeline %llu us at %llx",
+          static_cast<unsigned long long>(us),
+          static_cast<unsigned long long>(now));
+
+    const dwt_drv_t::time_t t = dwt_drv_t::get_timeline();
+    const uint64_t rem        = now % FREQ_HZ;
+    check(t.s == static_cast<uint32_t>(now / FREQ_HZ) &&
+              t.ms == rem / (FREQ_HZ / 1000) &&
+              t.us == rem % (FREQ_HZ / 1000) / CPU_FREQ_MHZ,
+          "timeline %u s %u ms %u us at %llx", t.s, t.ms, t.us,
+          static_cast<unsigned long long>(now));
+}
+
+/**
+ * @brief Single reader: random steps, with the clock parked on both sides
+ * of every wrap it meets.
+ */
+void test_sequential(std::mt19937_64 &rng)
+{
+    std::uniform_int_distribution<uint64_t> small(1, 0x1000);
+    std::uniform_int_distribution<uint64_t> large(1, MAX_GAP);
+    uint64_t last = read(0);
+    for (long i = 0; i < STEP_NUM; i++)
+    {
+        uint64_t step = (i & 1) ? small(rng) : large(rng);
+        if (0 == i % 64)
+        {
+            // Land on 0xFFFFFFFF, then step onto 0
+            step = 0xFFFFFFFF - static_cast<uint32_t>(now);
+            if (0 == step || step > MAX_GAP)
+            {
+                step = 1;
+            }
+        }
+        const uint64_t got = read(step);
+        check(got >= last, "went back from %llx to %llx",
+              static_cast<unsigned long long>(last),
+              static_cast<unsigned long long>(got));
+        last = got;
+        if (0 == i % 16)
+        {
+            check_conversions();
+        }
+    }
+    // Longest allowed silence, straight across a wrap
+    park_below_wrap(0x10);
+    read(MAX_GAP);
+    check_conversions();
+}
+
+/**
+ * @brief Readers preempted by others that move the state across a wrap.
+ */
+void test_preempted(std::mt19937_64 &rng)
+{
+    // The first nested reader after the outer one still has to see a gap
+    // below MAX_GAP from the last published state
+    constexpr uint64_t outer_gap = MAX_GAP - 2 * NESTED_MAX * NESTED_STEP;
+    std::uniform_int_distribution<int> nested(0, NESTED_MAX);
+    std::uniform_int_distribution<uint64_t> nested_step(1, NESTED_STEP);
+    std::uniform_int_distribution<uint64_t> before_wrap(0, 4 * NESTED_STEP);
+    for (long i = 0; i < STEP_NUM; i++)
+    {
+        // Park the outer reader just below a wrap so the nested readers
+        // cross it and publish the new state first
+        const uint64_t to_wrap = 0x100000000ULL - static_cast<uint32_t>(now);
+        const uint64_t lead    = before_wrap(rng);
+        uint64_t step          = to_wrap > lead ? to_wrap - lead : to_wrap;
+        if (step > outer_gap)
+        {
+            read(step - outer_gap);
+            step = outer_gap;
+        }
+        read(step, {nested(rng), nested(rng), nested_step(rng)});
+
+        // Readers after it must pick up whatever state survived
+        read(1);
+        check_conversions();
+    }
+
+    // Fixed cases: nested reader crosses the wrap before and after the
+    // sample, with the outer state holding top byte 0xFF
+    park_below_wrap(0x10);
+    read(0, {1, 0, 0x20});
+    park_below_wrap(0x10);
+    read(0, {0, 1, 0x20});
+    park_below_wrap(0x10);
+    read(0, {2, 2, 0x00FFFFFF});
+    read(1);
+
+    // A reader preempted for most of a wrap after it sampled must not roll
+    // the state back: the next reader comes MAX_GAP after the nested ones,
+    // which is past a wrap from the stale sample
+    for (int i = 0; i < 256; i++)
+    {
+        read(0x01000000 + i, {0, 2, 0x7F000000});
+        read(MAX_GAP);
+    }
+}
+
+/**
+ * @brief divide() against the 64-bit division at the edges.
+ */
+void test_divide(std::mt19937_64 &rng)
+{
+    const uint32_t divisors[] = {1,          2,          3,          7,
+                                 480,        1000,       480000,     550000,
+                                 480000000,  550000000,  0x7FFFFFFF, 0x80000000,
+                                 0x80000001, 0xFFFFFFFE, 0xFFFFFFFF};
+    for (const uint32_t d : divisors)
+    {
+        const uint64_t top = UINT64_MAX / d * d;
+        const uint64_t n_list[] = {0,
+                                   1,
+                                   d - 1ULL,
+                                   d,
+                                   d + 1ULL,
+                                   0xFFFFFFFFULL,
+                                   0x100000000ULL,
+                                   0x100000000ULL * d - 1,
+                                   0x100000000ULL * d,
+                                   (1ULL << 56) - 1,
+                                   1ULL << 56,
+                                   top - 1,
+                                   top,
+                                   UINT64_MAX - 1,
+                                   UINT64_MAX};
+        for (const uint64_t n : n_list)
+        {
+            const uint64_t q = pyro::host_test::dwt_probe_t::divide(n, d);
+            check(q == n / d, "%llx / %u = %llx, expected %llx",
+                  static_cast<unsigned long long>(n), d,
+                  static_cast<unsigned long long>(q),
+                  static_cast<unsigned long long>(n / d));
+        }
+        for (int i = 0; i < 100000; i++)
+        {
+            // Quotient boundaries: k * d and one below
+            const uint64_t k = rng() % (UINT64_MAX / d) + 1;
+            for (const uint64_t n : {k * d - 1, k * d, rng()})
+            {
+                check(pyro::host_test::dwt_probe_t::divide(n, d) == n / d,
+                      "%llx / %u", static_cast<unsigned long long>(n), d);
+            }
+        }
+    }
+}
+} // namespace
+
+int main()
+{
+    host_dwt.CYCCNT.read = read_cyccnt;
+    dwt_drv_t::init(CPU_FREQ_MHZ);
+    check((host_core_debug.DEMCR & CoreDebug_DEMCR_TRCENA_Msk) &&
+              (host_dwt.CTRL & DWT_CTRL_CYCCNTENA_Msk),
+          "init() did not enable CYCCNT");
+
+    std::mt19937_64 rng(17);
+    test_sequential(rng);
+    std::printf("sequential: %llu wraps\n",
+                static_cast<unsigned long long>(now >> 32));
+    const uint64_t wraps = now >> 32;
+    test_preempted(rng);
+    std::printf("preempted: %llu wraps\n",
+                static_cast<unsigned long long>((now >> 32) - wraps));
+    test_divide(rng);
+
+    return pyro::host_test::result("pyro_dwt_test");
+}
@@ -0,0 +1,73 @@
+/**
+ * @file pyro_host_test.h
+ * @brief Minimal check helpers for the host test programs.
+ *
+ * Each test is a plain executable registered with CTest: it prints what it
+ * compared and returns non-zero if any check failed.
+ *
+ * @version 1.0.0
+ * @date 2026-10-17
+ */
+
+#ifndef __PYRO_HOST_TEST_H__
+#define __PYRO_HOST_TEST_H__
+
+#include <chrono>
+#include <cstdio>
+
+namespace pyro
+{
+namespace host_test
+{
+inline int &fail_num()
+{
+    static int num = 0;
+    return num;
+}
+
+/**
+ * @brief Records one check, prints the message only when it fails.
+ */
+template <typename... Args>
+inline bool check(const bool ok, const char *fmt, Args... args)
+{
+    if (!ok)
+    {
+        if (fail_num()++ < 20)
+        {
+            std::printf("FAIL ");
+            std::printf(fmt, args...);
+            std::printf("\n");
+        }
+    }
+    return ok;
+}
+
+/**
+ * @brief Exit code of the test program, with a one-line summary.
+ */
+inline int result(const char *name)
+{
+    std::printf("%s: %s (%d failed checks)\n", name,
+                0 == fail_num() ? "PASS" : "FAIL", fail_num());
+    return 0 == fail_num() ? 0 : 1;
+}
+
+/**
+ * @brief Wall-clock nanoseconds per iteration of body(i), i in [0, num).
+ */
+template <typename F> inline double ns_per_iter(const long num, F &&body)
+{
+    const auto start = std::chrono::steady_clock::now();
+    for (long i = 0; i < num; i++)
+    {
+        body(i);
+    }
+    const auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(stop - start).count() /
+           static_cast<double>(num);
+}
+} // namespace host_test
+} // namespace pyro
+
+#endif
@@ -0,0 +1,42 @@
+/**
+ * @file pyro_ols_bench.cpp
+ * @brief Update cost of ols_buf_t against the original shifting OLS.
+ *
+ * Host nanoseconds per update() for a few window sizes. Only the ratio is
+ * meaningful, the M7 numbers come from the PID bench demo on target.
+ */
+
+#include "Ref/pyro_algo_ols_ref.h"
+#include "pyro_algo_ols.h"
+#include "pyro_host_test.h"
+
+#include <cmath>
+#include <cstdio>
+
+namespace
+{
+constexpr long UPDATE_NUM = 2000000;
+
+template <typename Ols> double bench(const uint16_t order)
+{
+    Ols ols(order);
+    volatile float sink = 0.0f;
+    const double ns     = pyro::host_test::ns_per_iter(UPDATE_NUM, [&](long i) {
+        ols.update(0.001f, std::sin(0.01f * static_cast<float>(i & 1023)));
+        sink = ols.get_derivative();
+    });
+    (void)sink;
+    return ns;
+}
+} // namespace
+
+int main()
+{
+    std::printf("order  shifting ns  ring ns\n");
+    for (const uint16_t order : {2, 5, 8, 16})
+    {
+        std::printf("%5u  %11.1f  %7.1f\n", order,
+                    bench<pyro::ols_ref_t>(order), bench<pyro::ols_t>(order));
+    }
+    return 0;
+}
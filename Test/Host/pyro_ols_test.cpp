@@ -0,0 +1,113 @@
+/**
+ * @file pyro_ols_test.cpp
+ * @brief ols_buf_t against the original shifting OLS, orders 2..16.
+ *
+ * Both filters see the same noisy sine with a jittered sample period. Every
+ * update compares slope, smoothed value and mean absolute deviation, during
+ * warm-up (fewer samples than the order) and in steady state. The two
+ * differ only in float rounding: the ring keeps running sums and rebases x
+ * once per window, the reference re-sums a freshly shifted window.
+ */
+
+#include "Ref/pyro_algo_ols_ref.h"
+#include "pyro_algo_ols.h"
+#include "pyro_host_test.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+namespace
+{
+constexpr long SAMPLE_NUM = 200000;
+
+// Relative to the magnitude of the compared value, plus a floor for values
+// that pass through zero. About 10x above the worst cases observed. During
+// warm-up neither side has rebased yet, so they agree much more closely.
+constexpr float K_TOL       = 2e-3f;
+constexpr float SMOOTH_TOL  = 5e-5f;
+constexpr float DEV_TOL     = 5e-3f;
+constexpr float WARM_UP_TOL = 2e-5f;
+
+struct max_err_t
+{
+    float k;
+    float smooth;
+    float dev;
+};
+
+float rel_err(const float a, const float b, const float floor)
+{
+    return std::fabs(a - b) / (std::fabs(b) + floor);
+}
+
+/**
+ * @brief Feeds both filters and keeps the worst relative errors seen during
+ * warm-up (the first order samples) and in steady state.
+ */
+void run(const uint16_t order, max_err_t &warm_up, max_err_t &steady)
+{
+    pyro::ols_t ols(order);
+    pyro::ols_ref_t ref(order);
+    std::mt19937 rng(order);
+    std::uniform_real_distribution<float> jitter(0.8f, 1.2f);
+    std::normal_distribution<float> noise(0.0f, 0.05f);
+
+    warm_up = steady = max_err_t{};
+    float t          = 0.0f;
+    for (long i = 0; i < SAMPLE_NUM; i++)
+    {
+        const float dt = 0.001f * jitter(rng);
+        t += dt;
+        const float y = 10.0f * std::sin(2.0f * 3.14159265f * 3.0f * t) +
+                        noise(rng);
+        ols.update(dt, y);
+        ref.update(dt, y);
+
+        // Slope scale: the sine peaks at ~190/s, noise alone gives ~50/s
+        // over a short window
+        max_err_t &err = i < order ? warm_up : steady;
+        err.k        = std::max(err.k, rel_err(ols.get_derivative(),
+                                               ref.get_derivative(), 100.0f));
+        err.smooth   = std::max(err.smooth, rel_err(ols.get_smooth(),
+                                                    ref.get_smooth(), 10.0f));
+        err.dev      = std::max(err.dev,
+                                rel_err(ols.get_mean_absolute_deviation(),
+                                        ref.get_mean_absolute_deviation(),
+                                        0.05f));
+    }
+}
+} // namespace
+
+int main()
+{
+    using pyro::host_test::check;
+
+    std::printf("order  warm-up k / smooth / dev       "
+                "steady k / smooth / dev\n");
+    for (uint16_t order = 2; order <= pyro::OLS_MAX_ORDER; order++)
+    {
+        max_err_t warm_up, steady;
+        run(order, warm_up, steady);
+        std::printf("%5u  %.1e / %.1e / %.1e    %.1e / %.1e / %.1e\n",
+                    order, warm_up.k, warm_up.smooth, warm_up.dev, steady.k,
+                    steady.smooth, steady.dev);
+        check(warm_up.k <= WARM_UP_TOL && warm_up.smooth <= WARM_UP_TOL &&
+                  warm_up.dev <= WARM_UP_TOL,
+              "order %u: warm-up error %g / %g / %g", order, warm_up.k,
+              warm_up.smooth, warm_up.dev);
+        check(steady.k <= K_TOL, "order %u: slope error %g", order, steady.k);
+        check(steady.smooth <= SMOOTH_TOL, "order %u: smooth error %g", order,
+              steady.smooth);
+        check(steady.dev <= DEV_TOL, "order %u: deviation error %g", order,
+              steady.dev);
+    }
+
+    // Orders outside [2, capacity] are clamped rather than overrunning
+    check(pyro::ols_t(0).get_order() == 2, "order 0 not clamped to 2");
+    check(pyro::ols_t(64).get_order() == pyro::OLS_MAX_ORDER,
+          "order 64 not clamped to capacity");
+
+    return pyro::host_test::result("pyro_ols_test");
+}
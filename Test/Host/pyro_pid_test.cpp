@@ -0,0 +1,385 @@
+/**
+ * @file pyro_pid_test.cpp
+ * @brief Host tests of the PID family against pid_t.
+ *
+ * pid_t is the reference. The other controllers claim bit-identical output
+ * for the same inputs and dt, so every case drives both sides through the
+ * same noisy closed loop and compares the raw float bits each step.
+ *
+ * The closed-loop harness drives pid_t alone against simulated plants and
+ * checks its step response, as a regression guard for tuning-visible
+ * changes, and reports host ns/step.
+ *
+ * pid_q31_t works in integers and is compared against pid_t within a
+ * tolerance in raw output units instead.
+ */
+
+#include "pyro_algo_pid.h"
+#include "pyro_algo_pid_bank.h"
+#include "pyro_algo_pid_policy.h"
+#include "pyro_algo_pid_q31.h"
+#include "pyro_dwt_stub.h"
+#include "pyro_host_test.h"
+
+#include <cmath>
+#include <cstring>
+#include <random>
+
+namespace
+{
+using pyro::host_test::check;
+using namespace pyro::pid_policy;
+using ref_pid_t = pyro::pid_t; // POSIX has a pid_t too
+
+constexpr long STEP_NUM = 200000;
+
+bool same_bits(const float a, const float b)
+{
+    return 0 == std::memcmp(&a, &b, sizeof(float));
+}
+
+/**
+ * @brief Runs pid_t on the DWT path and the policy class on the explicit-dt
+ * path. dt is jittered, sometimes zero, and the reference sometimes equals
+ * the measurement exactly.
+ */
+template <typename Policy_pid>
+void policy_parity(const char *name, ref_pid_t &ref_pid, Policy_pid &pid)
+{
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> uni(-1.0f, 1.0f);
+    float measure = 0.0f;
+    float ref     = 0.0f;
+    int mismatch  = 0;
+    for (long k = 0; k < STEP_NUM; k++)
+    {
+        if (0 == k % 500)
+            ref = uni(rng) * 50.0f;
+        if (3 == k % 777)
+            ref = measure; // Exact zero error
+        const float dt =
+            (5 == k % 997) ? 0.0f : 0.001f * (1.0f + 0.2f * uni(rng));
+        pyro::host_test::set_delta_t(dt);
+
+        const float out_ref = ref_pid.calculate(ref, measure);
+        const float out     = pid.calculate(ref, measure, dt);
+        if (!same_bits(out_ref, out) ||
+            !same_bits(ref_pid.get_p_out(), pid.get_p_out()) ||
+            !same_bits(ref_pid.get_i_out(), pid.get_i_out()))
+        {
+            mismatch++;
+        }
+        measure += (out_ref * 0.5f - measure * 0.05f) * 0.1f +
+                   uni(rng) * 0.01f;
+    }
+    std::printf("policy %-9s %ld steps, %d mismatches, %zu vs %zu bytes\n",
+                name, STEP_NUM, mismatch, sizeof(ref_pid), sizeof(pid));
+    check(0 == mismatch, "policy %s: %d steps differ from pid_t", name,
+          mismatch);
+}
+
+void test_policy()
+{
+    {
+        ref_pid_t ref_pid(24.0f, 0.1f, 0.0f, 5.0f, 100.0f);
+        pyro::chassis_pid_t pid({24.0f, 0.1f, 0.0f, 100.0f, 5.0f});
+        policy_parity("chassis", ref_pid, pid);
+    }
+    {
+        ref_pid_t ref_pid(2.0f, 5.0f, 0.05f, 10.0f, 30.0f, 50.0f, 100.0f, 0,
+                          ref_pid_t::INTEGRAL_LIMIT |
+                              ref_pid_t::DERIVATIVE_ON_MEASUREMENT |
+                              ref_pid_t::OUTPUT_FILTER |
+                              ref_pid_t::DERIVATIVE_FILTER);
+        pyro::gimbal_pid_t pid(
+            {2.0f, 5.0f, 0.05f, 30.0f, 10.0f, 0.0f, 0.0f, 0.0f, 50.0f, 100.0f});
+        policy_parity("gimbal", ref_pid, pid);
+    }
+    {
+        ref_pid_t ref_pid(30.0f, 10.0f, 0.5f, 2.0f, 1.0f, 3.0f, 0.1f, 1.0f,
+                          50.0f, 100.0f, 8, 0xFF & ~ref_pid_t::ERROR_HANDLE);
+        pyro::policy_pid_t<integral_limit, derivative_on_measurement,
+                           trapezoid_integral, output_filter,
+                           changing_integration_rate, derivative_filter,
+                           deadband, ols_derivative<8>>
+            pid({2.0f, 1.0f, 3.0f, 30.0f, 10.0f, 0.5f, 0.1f, 1.0f, 50.0f,
+                 100.0f});
+        policy_parity("all_ols8", ref_pid, pid);
+    }
+    {
+        ref_pid_t ref_pid(30.0f, 10.0f, 0.5f, 2.0f, 1.0f, 3.0f, 0.1f, 1.0f,
+                          0.0f, 0.0f, 0,
+                          ref_pid_t::TRAPEZOID_INTEGRAL |
+                              ref_pid_t::CHANGING_INTEGRATION_RATE |
+                              ref_pid_t::INTEGRAL_LIMIT);
+        pyro::policy_pid_t<integral_limit, trapezoid_integral,
+                           changing_integration_rate, deadband>
+            pid({2.0f, 1.0f, 3.0f, 30.0f, 10.0f, 0.5f, 0.1f, 1.0f});
+        policy_parity("trap_cir", ref_pid, pid);
+    }
+    {
+        ref_pid_t ref_pid(1.0f, 0.5f, 0.2f, 5.0f, 10.0f, 0.0f, 0.0f, 6);
+        pyro::policy_pid_t<integral_limit, output_filter, derivative_filter,
+                           ols_derivative<6>>
+            pid({1.0f, 0.5f, 0.2f, 10.0f, 5.0f});
+        policy_parity("err_ols6", ref_pid, pid);
+    }
+}
+
+/**
+ * @brief Runs N independent pid_t on the DWT path against one N-lane bank
+ * on the explicit-dt path, each lane with its own reference and plant.
+ */
+template <uint8_t N>
+void bank_parity(const char *name, const uint8_t improve,
+                 const pyro::pid_param_t *param)
+{
+    pyro::pid_bank_t<N> bank(improve);
+    ref_pid_t *ref_pid[N];
+    for (uint8_t i = 0; i < N; i++)
+    {
+        const pyro::pid_param_t &p = param[i];
+        bank.set_lane(i, p);
+        ref_pid[i] = new ref_pid_t(p.max_out, p.integral_limit, p.deadband,
+                                   p.kp, p.ki, p.kd, p.coef_a, p.coef_b,
+                                   p.output_cutoff_hz, p.derivative_cutoff_hz,
+                                   0, improve);
+    }
+
+    std::mt19937 rng(2);
+    std::uniform_real_distribution<float> uni(-1.0f, 1.0f);
+    typename pyro::pid_bank_t<N>::lanes_t ref{}, measure{};
+    int mismatch = 0;
+    for (long k = 0; k < STEP_NUM; k++)
+    {
+        for (uint8_t i = 0; i < N; i++)
+        {
+            if (0 == k % (400 + i))
+                ref[i] = uni(rng) * 50.0f;
+            if (3 == k % 777)
+                ref[i] = measure[i]; // Exact zero error
+        }
+        const float dt =
+            (5 == k % 997) ? 0.0f : 0.001f * (1.0f + 0.2f * uni(rng));
+        pyro::host_test::set_delta_t(dt);
+
+        float out_ref[N];
+        for (uint8_t i = 0; i < N; i++)
+        {
+            out_ref[i] = ref_pid[i]->calculate(ref[i], measure[i]);
+        }
+        const auto &out = bank.calculate(ref, measure, dt);
+        for (uint8_t i = 0; i < N; i++)
+        {
+            if (!same_bits(out_ref[i], out[i]) ||
+                !same_bits(ref_pid[i]->get_p_out(), bank.get_p_out(i)) ||
+                !same_bits(ref_pid[i]->get_i_out(), bank.get_i_out(i)) ||
+                !same_bits(ref_pid[i]->get_d_out(), bank.get_d_out(i)))
+            {
+                mismatch++;
+            }
+            measure[i] += (out_ref[i] * 0.5f - measure[i] * 0.05f) * 0.1f +
+                          uni(rng) * 0.01f;
+        }
+    }
+    for (ref_pid_t *pid : ref_pid)
+    {
+        delete pid;
+    }
+    std::printf("bank   %-9s %u lanes, %ld steps, %d mismatches\n", name, N,
+                STEP_NUM, mismatch);
+    check(0 == mismatch, "bank %s: %d lane steps differ from pid_t", name,
+          mismatch);
+}
+
+void test_bank()
+{
+    // Chassis wheels, steering, and one gimbal-like lane with every option
+    const pyro::pid_param_t lanes[7] = {
+        {24.0f, 0.1f, 0.0f, 100.0f, 5.0f},
+        {24.0f, 0.1f, 0.0f, 100.0f, 5.0f},
+        {20.0f, 0.1f, 0.0f, 100.0f, 5.0f},
+        {20.0f, 0.1f, 0.0f, 100.0f, 5.0f},
+        {10.0f, 1.0f, 0.0f, 30.0f, 10.0f},
+        {10.0f, 1.0f, 0.0f, 30.0f, 10.0f},
+        {2.0f, 5.0f, 0.05f, 30.0f, 10.0f, 0.2f, 0.5f, 1.0f, 50.0f, 100.0f},
+    };
+    bank_parity<7>("limit", ref_pid_t::INTEGRAL_LIMIT, lanes);
+    bank_parity<7>("all", 0xFF & ~ref_pid_t::ERROR_HANDLE, lanes);
+    bank_parity<7>("trap_dom",
+                   ref_pid_t::TRAPEZOID_INTEGRAL |
+                       ref_pid_t::DERIVATIVE_ON_MEASUREMENT |
+                       ref_pid_t::DERIVATIVE_FILTER,
+                   lanes);
+    bank_parity<1>("one",
+                   ref_pid_t::INTEGRAL_LIMIT | ref_pid_t::OUTPUT_FILTER,
+                   lanes + 6);
+}
+struct step_response_t
+{
+    float rise;      // 10 % -> 90 % of the first unit step, seconds
+    float overshoot; // Peak above the target, percent
+    float settled;   // |y - 1| at the end of the first step
+    double ns;       // Host nanoseconds per calculate() + plant step
+};
+
+/**
+ * @brief Runs pid_t with an explicit dt against a plant. The reference is a
+ * unit square wave with a 2 * TOGGLE_STEP period, the first high half is
+ * measured.
+ */
+template <typename Plant>
+step_response_t closed_loop(ref_pid_t &pid, Plant &&plant, const float dt)
+{
+    constexpr long LOOP_STEP_NUM = 1000000;
+    constexpr long TOGGLE_STEP   = 20000;
+
+    float y = 0.0f, v = 0.0f;
+    float t10 = -1.0f, t90 = -1.0f, peak = 0.0f, settled = 0.0f;
+    volatile float sink = 0.0f;
+    const double ns = pyro::host_test::ns_per_iter(LOOP_STEP_NUM, [&](long k) {
+        const float ref = ((k / TOGGLE_STEP) & 1) ? 0.0f : 1.0f;
+        const float u   = pid.calculate(ref, y, dt);
+        plant(y, v, u, dt);
+        if (k < TOGGLE_STEP)
+        {
+            const float t = static_cast<float>(k) * dt;
+            if (t10 < 0.0f && y >= 0.1f)
+                t10 = t;
+            if (t90 < 0.0f && y >= 0.9f)
+                t90 = t;
+            if (y > peak)
+                peak = y;
+            settled = std::fabs(y - 1.0f);
+        }
+        sink = sink + y;
+    });
+    (void)sink;
+    return {t90 - t10, (peak - 1.0f) * 100.0f, settled, ns};
+}
+
+void check_response(const char *name, const step_response_t &res,
+                    const float rise, const float overshoot)
+{
+    std::printf("loop   %-23s rise %5.1f ms, overshoot %5.1f %%, "
+                "%5.1f ns/step\n",
+                name, res.rise * 1e3f, res.overshoot, res.ns);
+    check(std::fabs(res.rise - rise) <= 0.002f, "%s: rise %g s, expected %g",
+          name, res.rise, rise);
+    check(std::fabs(res.overshoot - overshoot) <= 2.0f,
+          "%s: overshoot %g %%, expected %g", name, res.overshoot, overshoot);
+    check(res.settled <= 0.01f, "%s: still %g off target after the step",
+          name, res.settled);
+}
+
+void test_closed_loop()
+{
+    constexpr float DT = 0.001f;
+
+    // tau * y' = -y + 2 u, tau = 50 ms
+    auto first_order = [](float &y, float &, const float u, const float dt) {
+        y += dt / 0.05f * (-y + 2.0f * u);
+    };
+    // y'' = w^2 (u - y) - 2 z w y', w = 30 rad/s, z = 0.3
+    auto second_order = [](float &y, float &v, const float u, const float dt) {
+        constexpr float w = 30.0f, z = 0.3f;
+        v += dt * (w * w * u - 2.0f * z * w * v - w * w * y);
+        y += dt * v;
+    };
+
+    {
+        ref_pid_t pid(3.0f, 20.0f, 0.0f, 5.0f, 10.0f);
+        check_response("1st order, PI", closed_loop(pid, first_order, DT),
+                       0.031f, 0.0f);
+    }
+    {
+        ref_pid_t pid(10.0f, 2.0f, 0.02f, 10.0f, 30.0f, 0.0f, 0.0f, 0,
+                      ref_pid_t::INTEGRAL_LIMIT |
+                          ref_pid_t::DERIVATIVE_ON_MEASUREMENT);
+        check_response("2nd order, PID D-on-M",
+                       closed_loop(pid, second_order, DT), 0.013f, 42.0f);
+    }
+    {
+        ref_pid_t pid(10.0f, 2.0f, 0.02f, 10.0f, 30.0f, 50.0f, 100.0f, 8,
+                      ref_pid_t::INTEGRAL_LIMIT |
+                          ref_pid_t::DERIVATIVE_ON_MEASUREMENT |
+                          ref_pid_t::OUTPUT_FILTER |
+                          ref_pid_t::DERIVATIVE_FILTER);
+        check_response("2nd order, LPFs, OLS(8)",
+                       closed_loop(pid, second_order, DT), 0.012f, 70.0f);
+    }
+}
+/**
+ * @brief pid_q31_t against pid_t with INTEGRAL_LIMIT in raw units, the way
+ * a motor loop uses it: integer reference and measurement in, int16 current
+ * out, driving a noisy first-order plant. pid_t sees the same integers.
+ */
+void test_q31()
+{
+    // Largest |pid_t - pid_q31_t| allowed, in raw output units. The int16
+    // result alone accounts for up to 0.5.
+    constexpr float Q31_TOL     = 1.0f;
+    constexpr long Q31_STEP_NUM = 1000000;
+    constexpr float DT          = 0.001f;
+
+    struct q31_case_t
+    {
+        const char *name;
+        float kp, ki, kd, integral_limit, max_out, deadband;
+        float in_range, out_range;
+        int ref_amp;
+    };
+    // M3508 speed loop (rpm in, current out), with deadband and D, and an
+    // 8192-count encoder position loop
+    const q31_case_t cases[] = {
+        {"speed", 10.0f, 200.0f, 0.0f, 8000.0f, 16000.0f, 0.0f, 16384.0f,
+         16384.0f, 3000},
+        {"speed_db_d", 10.0f, 200.0f, 0.01f, 8000.0f, 16000.0f, 5.0f,
+         16384.0f, 16384.0f, 3000},
+        {"encoder", 4.0f, 2.0f, 0.005f, 3000.0f, 16000.0f, 2.0f, 8192.0f,
+         16384.0f, 4000},
+    };
+
+    for (const q31_case_t &c : cases)
+    {
+        ref_pid_t ref_pid(c.max_out, c.integral_limit, c.deadband, c.kp, c.ki,
+                          c.kd, 0.0f, 0.0f, 0.0f, 0.0f, 0,
+                          ref_pid_t::INTEGRAL_LIMIT);
+        pyro::pid_q31_t pid(c.kp, c.ki, c.kd, c.integral_limit, c.max_out,
+                            c.deadband, DT, c.in_range, c.out_range);
+
+        std::mt19937 rng(3);
+        std::uniform_real_distribution<float> uni(-1.0f, 1.0f);
+        float y         = 0.0f;
+        int32_t ref     = 0;
+        double max_diff = 0.0, sum_diff = 0.0;
+        for (long k = 0; k < Q31_STEP_NUM; k++)
+        {
+            if (0 == k % 3000)
+                ref = static_cast<int32_t>(uni(rng) * c.ref_amp);
+            const auto measure  = static_cast<int32_t>(std::lrint(y));
+            const float out_ref = ref_pid.calculate(
+                static_cast<float>(ref), static_cast<float>(measure), DT);
+            const int16_t out = pid.calculate_raw(ref, measure);
+
+            const double diff = std::fabs(out_ref - out);
+            max_diff          = diff > max_diff ? diff : max_diff;
+            sum_diff += diff;
+            y += DT / 0.02f * (-y + 0.5f * out) + uni(rng) * 2.0f;
+        }
+        std::printf("q31    %-10s max |diff| %.2f, mean %.3f raw units\n",
+                    c.name, max_diff, sum_diff / Q31_STEP_NUM);
+        check(max_diff <= Q31_TOL, "q31 %s: max |diff| %g raw units",
+              c.name, max_diff);
+    }
+}
+} // namespace
+
+int main()
+{
+    test_policy();
+    test_bank();
+    test_closed_loop();
+    test_q31();
+    return pyro::host_test::result("pyro_pid_test");
+}
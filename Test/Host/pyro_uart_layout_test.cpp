@@ -0,0 +1,182 @@
+/**
+ * @file pyro_uart_layout_test.cpp
+ * @brief plan_uart_layout() over the default table and edge configurations.
+ *
+ * Every placed buffer must start on a 32-byte cache line, own whole lines
+ * that no other buffer touches, and lie inside the block. The block must be
+ * a whole number of lines with one line of slack for aligning it. The
+ * default table, allocated as the DMA heap does it, must fit in .dma_heap.
+ */
+
+#include "pyro_host_test.h"
+#include "pyro_uart_layout.h"
+
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+// configTOTAL_DMA_HEAP_SIZE (Core/Inc/FreeRTOSConfig.h)
+constexpr size_t DMA_HEAP_SIZE = 8192;
+// pyro_core_dma_heap.c on the Cortex-M7: 8-byte BlockLink_t and alignment,
+// up to 7 bytes lost aligning the heap start and an 8-byte end marker.
+constexpr size_t HEAP_ALIGN      = 8;
+constexpr size_t HEAP_BLOCK_HEAD = 8;
+constexpr size_t HEAP_FIXED_COST = 7 + 8;
+
+struct span_t
+{
+    const char *name;
+    size_t offset;
+    size_t size;
+};
+
+size_t lines(const size_t size)
+{
+    return (size + pyro::UART_CACHE_LINE - 1) / pyro::UART_CACHE_LINE *
+           pyro::UART_CACHE_LINE;
+}
+
+/**
+ * @brief Checks one configuration that plan_uart_layout() should accept.
+ */
+void check_layout(const pyro::uart_buf_cfg_t &cfg)
+{
+    using pyro::host_test::check;
+
+    const pyro::uart_buf_layout_t layout = pyro::plan_uart_layout(cfg);
+    const unsigned rx = cfg.rx_buf_size, num = cfg.rx_buf_num,
+                   ring = cfg.rx_ring_size, tx = cfg.tx_ring_size;
+    if (!check(layout.size != 0, "{%u,%u,%u,%u}: rejected", rx, num, ring,
+               tx))
+    {
+        return;
+    }
+
+    std::vector<span_t> spans{{"rx_buf[0]", layout.rx_buf[0], rx}};
+    if (num > 1)
+    {
+        spans.push_back({"rx_buf[1]", layout.rx_buf[1], rx});
+    }
+    else
+    {
+        check(layout.rx_buf[1] == layout.rx_buf[0],
+              "{%u,%u,%u,%u}: single RX buffer not shared", rx, num, ring,
+              tx);
+    }
+    if (ring)
+    {
+        spans.push_back({"rx_ring", layout.rx_ring, ring});
+    }
+    if (pyro::uart_tx_ring_valid(cfg.tx_ring_size))
+    {
+        spans.push_back({"tx_ring", layout.tx_ring, tx});
+    }
+    else
+    {
+        // The driver keys "no TX ring" off the ring starting at the end
+        check(layout.tx_ring == layout.size,
+              "{%u,%u,%u,%u}: unused TX ring inside the block", rx, num,
+              ring, tx);
+    }
+
+    size_t used = 0;
+    for (size_t i = 0; i < spans.size(); i++)
+    {
+        const span_t &a = spans[i];
+        used += lines(a.size);
+        check(0 == a.offset % pyro::UART_CACHE_LINE,
+              "{%u,%u,%u,%u}: %s at %zu not line aligned", rx, num, ring, tx,
+              a.name, a.offset);
+        check(a.offset + lines(a.size) <= layout.size,
+              "{%u,%u,%u,%u}: %s ends past the block", rx, num, ring, tx,
+              a.name);
+        for (size_t j = i + 1; j < spans.size(); j++)
+        {
+            const span_t &b = spans[j];
+            check(a.offset + lines(a.size) <= b.offset ||
+                      b.offset + lines(b.size) <= a.offset,
+                  "{%u,%u,%u,%u}: %s and %s share a line", rx, num, ring, tx,
+                  a.name, b.name);
+        }
+    }
+    check(0 == layout.size % pyro::UART_CACHE_LINE,
+          "{%u,%u,%u,%u}: block of %zu not whole lines", rx, num, ring, tx,
+          layout.size);
+    check(used == layout.size, "{%u,%u,%u,%u}: %zu of %zu bytes unused", rx,
+          num, ring, tx, layout.size - used, layout.size);
+    check(layout.alloc_size == layout.size + pyro::UART_CACHE_LINE - 1,
+          "{%u,%u,%u,%u}: no slack to align the block", rx, num, ring, tx);
+}
+
+/**
+ * @brief DMA heap bytes taken by one allocation, header and padding included.
+ */
+size_t heap_cost(const size_t size)
+{
+    return (size + HEAP_BLOCK_HEAD + HEAP_ALIGN - 1) / HEAP_ALIGN * HEAP_ALIGN;
+}
+} // namespace
+
+int main()
+{
+    using pyro::host_test::check;
+
+    std::printf("default table       size  alloc\n");
+    size_t heap_used = HEAP_FIXED_COST;
+    for (const pyro::uart_buf_cfg_t &cfg : pyro::uart_default_buf_cfg)
+    {
+        check_layout(cfg);
+        const pyro::uart_buf_layout_t layout = pyro::plan_uart_layout(cfg);
+        heap_used += heap_cost(layout.alloc_size);
+        char name[24];
+        std::snprintf(name, sizeof(name), "{%u,%u,%u,%u}", cfg.rx_buf_size,
+                      cfg.rx_buf_num, cfg.rx_ring_size, cfg.tx_ring_size);
+        std::printf("%-16s  %5zu  %5zu\n", name, layout.size,
+                    layout.alloc_size);
+    }
+    std::printf("DMA heap: %zu of %zu bytes\n", heap_used, DMA_HEAP_SIZE);
+    check(heap_used <= DMA_HEAP_SIZE, "default table needs %zu of %zu bytes",
+          heap_used, DMA_HEAP_SIZE);
+
+    // Zero rings, odd sizes, a single RX buffer, TX rings the driver drops
+    // (not a power of two) and the largest one it keeps
+    const pyro::uart_buf_cfg_t edge_cfg[] = {
+        {1, 1, 0, 0},      {1, 2, 0, 0},     {32, 2, 0, 0},
+        {33, 2, 0, 0},     {37, 1, 1, 0},    {42, 2, 0, 1024},
+        {42, 2, 512, 0},   {31, 2, 33, 64},  {64, 2, 96, 100},
+        {17, 1, 0, 1},     {18, 2, 0, 2},    {255, 2, 65535, 0x8000},
+        {65535, 2, 0, 0},
+    };
+    for (const pyro::uart_buf_cfg_t &cfg : edge_cfg)
+    {
+        check_layout(cfg);
+    }
+
+    // No RX buffer, or a buffer count the driver cannot use
+    const pyro::uart_buf_cfg_t invalid_cfg[] = {
+        {0, 2, 512, 1024},
+        {42, 0, 0, 0},
+        {42, 3, 0, 0},
+    };
+    for (const pyro::uart_buf_cfg_t &cfg : invalid_cfg)
+    {
+        const pyro::uart_buf_layout_t layout = pyro::plan_uart_layout(cfg);
+        check(0 == layout.size && 0 == layout.alloc_size,
+              "{%u,%u,%u,%u}: invalid configuration accepted",
+              cfg.rx_buf_size, cfg.rx_buf_num, cfg.rx_ring_size,
+              cfg.tx_ring_size);
+    }
+
+    // Ring sizes the TX queue accepts
+    check(!pyro::uart_tx_ring_valid(0), "TX ring 0 accepted");
+    check(!pyro::uart_tx_ring_valid(100), "TX ring 100 accepted");
+    check(!pyro::uart_tx_ring_valid(0xC000), "TX ring 0xC000 accepted");
+    for (uint32_t size = 1; size <= 0x8000; size <<= 1)
+    {
+        check(pyro::uart_tx_ring_valid(static_cast<uint16_t>(size)),
+              "TX ring %u rejected", size);
+    }
+
+    return pyro::host_test::result("pyro_uart_layout_test");
+}